@@ -0,0 +1,551 @@
+#include "BatchSimulator.hpp"
+#include <chrono>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BATCH_HAVE_SSE 1
+#endif
+
+namespace {
+
+    constexpr float DEG_TO_RAD = 0.01745329251994329577f;
+    constexpr float THETA_MAX = 75.0f;
+    constexpr float BALL_PASS_THROUGH_LIM = 0.6f;
+
+    // bounces resolved per tick; Simulation::step allows more, but a ball
+    // rarely meets more than a paddle and a wall within one tick
+    constexpr int BOUNCE_PASSES = 3;
+
+    // Constants derived from SimConfig once per step instead of once per match.
+    struct BatchParams
+    {
+        float dt;
+        float p1_step;
+        float p2_step;
+
+        float p1_x;
+        float p2_x;
+        float p1_half_h;
+        float p2_half_h;
+
+        float collision_x_1;
+        float collision_x_2;
+        float angle_scale_1;
+        float angle_scale_2;
+        float reflect_1;
+        float reflect_2;
+
+        float passed_x_1;
+        float passed_x_2;
+        float out_left;
+        float out_right;
+
+        float wall_up;
+        float wall_down;
+
+        float spawn_x;
+        float spawn_y;
+        float spawn_vx;
+        float spawn_phase;
+        float serve_delay;
+    };
+
+    struct ScalarOps
+    {
+        static constexpr size_t WIDTH = 1;
+        using V = float;
+        using M = bool;
+
+        static V set1(float x) { return x; }
+        static V load(const float *p) { return *p; }
+        static void store(float *p, V v) { *p = v; }
+        static V add(V a, V b) { return a + b; }
+        static V sub(V a, V b) { return a - b; }
+        static V mul(V a, V b) { return a * b; }
+        static V div(V a, V b) { return a / b; }
+        static V max(V a, V b) { return a > b ? a : b; }
+        static V neg(V a) { return -a; }
+        static M lt(V a, V b) { return a < b; }
+        static M le(V a, V b) { return a <= b; }
+        static M ge(V a, V b) { return a >= b; }
+        static M eq(V a, V b) { return a == b; }
+        static M mand(M a, M b) { return a && b; }
+        static M mor(M a, M b) { return a || b; }
+        static M mandnot(M a, M b) { return !a && b; }
+        static V select(M m, V a, V b) { return m ? a : b; }
+        static V ones(M m) { return m ? 1.0f : 0.0f; }
+    };
+
+#if defined(BATCH_HAVE_SSE)
+    struct SseOps
+    {
+        static constexpr size_t WIDTH = 4;
+        using V = __m128;
+        using M = __m128;
+
+        static V set1(float x) { return _mm_set1_ps(x); }
+        static V load(const float *p) { return _mm_loadu_ps(p); }
+        static void store(float *p, V v) { _mm_storeu_ps(p, v); }
+        static V add(V a, V b) { return _mm_add_ps(a, b); }
+        static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+        static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+        static V div(V a, V b) { return _mm_div_ps(a, b); }
+        static V max(V a, V b) { return _mm_max_ps(a, b); }
+        static V neg(V a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+        static M lt(V a, V b) { return _mm_cmplt_ps(a, b); }
+        static M le(V a, V b) { return _mm_cmple_ps(a, b); }
+        static M ge(V a, V b) { return _mm_cmpge_ps(a, b); }
+        static M eq(V a, V b) { return _mm_cmpeq_ps(a, b); }
+        static M mand(M a, M b) { return _mm_and_ps(a, b); }
+        static M mor(M a, M b) { return _mm_or_ps(a, b); }
+        static M mandnot(M a, M b) { return _mm_andnot_ps(a, b); }
+        static V select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+        static V ones(M m) { return _mm_and_ps(m, _mm_set1_ps(1.0f)); }
+    };
+#endif
+
+#if defined(__AVX2__)
+    struct Avx2Ops
+    {
+        static constexpr size_t WIDTH = 8;
+        using V = __m256;
+        using M = __m256;
+
+        static V set1(float x) { return _mm256_set1_ps(x); }
+        static V load(const float *p) { return _mm256_loadu_ps(p); }
+        static void store(float *p, V v) { _mm256_storeu_ps(p, v); }
+        static V add(V a, V b) { return _mm256_add_ps(a, b); }
+        static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+        static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+        static V div(V a, V b) { return _mm256_div_ps(a, b); }
+        static V max(V a, V b) { return _mm256_max_ps(a, b); }
+        static V neg(V a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+        static M lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static M le(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+        static M ge(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+        static M eq(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+        static M mand(M a, M b) { return _mm256_and_ps(a, b); }
+        static M mor(M a, M b) { return _mm256_or_ps(a, b); }
+        static M mandnot(M a, M b) { return _mm256_andnot_ps(a, b); }
+        static V select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+        static V ones(M m) { return _mm256_and_ps(m, _mm256_set1_ps(1.0f)); }
+    };
+#endif
+
+    // Taylor series good to ~1e-8 on [-75, 75] degrees, the full range of paddle angles.
+    template <class Ops>
+    inline void sinCos(typename Ops::V x, typename Ops::V &s, typename Ops::V &c)
+    {
+        typename Ops::V x2 = Ops::mul(x, x);
+
+        s = Ops::set1(-1.0f / 39916800.0f);
+        s = Ops::add(Ops::mul(s, x2), Ops::set1(1.0f / 362880.0f));
+        s = Ops::add(Ops::mul(s, x2), Ops::set1(-1.0f / 5040.0f));
+        s = Ops::add(Ops::mul(s, x2), Ops::set1(1.0f / 120.0f));
+        s = Ops::add(Ops::mul(s, x2), Ops::set1(-1.0f / 6.0f));
+        s = Ops::add(Ops::mul(s, x2), Ops::set1(1.0f));
+        s = Ops::mul(s, x);
+
+        c = Ops::set1(1.0f / 479001600.0f);
+        c = Ops::add(Ops::mul(c, x2), Ops::set1(-1.0f / 3628800.0f));
+        c = Ops::add(Ops::mul(c, x2), Ops::set1(1.0f / 40320.0f));
+        c = Ops::add(Ops::mul(c, x2), Ops::set1(-1.0f / 720.0f));
+        c = Ops::add(Ops::mul(c, x2), Ops::set1(1.0f / 24.0f));
+        c = Ops::add(Ops::mul(c, x2), Ops::set1(-0.5f));
+        c = Ops::add(Ops::mul(c, x2), Ops::set1(1.0f));
+    }
+}
+
+struct BatchLanes
+{
+    float *ball_x;
+    float *ball_y;
+    float *ball_vx;
+    float *ball_vy;
+    float *p1_y;
+    float *p2_y;
+    const float *p1_dir;
+    const float *p2_dir;
+    float *phase;
+    float *serve_timer;
+    float *score_1;
+    float *score_2;
+    float *hits_1;
+    float *hits_2;
+
+    explicit BatchLanes(BatchSimulator &sim) :
+        ball_x(sim.ball_x.data()), ball_y(sim.ball_y.data()),
+        ball_vx(sim.ball_vx.data()), ball_vy(sim.ball_vy.data()),
+        p1_y(sim.p1_y.data()), p2_y(sim.p2_y.data()),
+        p1_dir(sim.p1_dir.data()), p2_dir(sim.p2_dir.data()),
+        phase(sim.phase.data()), serve_timer(sim.serve_timer.data()),
+        score_1(sim.score_1.data()), score_2(sim.score_2.data()),
+        hits_1(sim.hits_1.data()), hits_2(sim.hits_2.data())
+    {
+    }
+};
+
+// Mirrors Simulation::step: serve countdown, swept paddle and wall bounces, scoring, respawn.
+template <class Ops>
+static void stepKernel(const BatchLanes &l, const BatchParams &bp, size_t begin, size_t end)
+{
+    using V = typename Ops::V;
+    using M = typename Ops::M;
+
+    const V dt = Ops::set1(bp.dt);
+    const V zero = Ops::set1(0.0f);
+    const V one = Ops::set1(1.0f);
+    const V two = Ops::set1(2.0f);
+    const V three = Ops::set1(3.0f);
+
+    for (size_t i = begin; i < end; i += Ops::WIDTH) {
+        V p1y = Ops::add(Ops::load(l.p1_y + i), Ops::mul(Ops::load(l.p1_dir + i), Ops::set1(bp.p1_step)));
+        V p2y = Ops::add(Ops::load(l.p2_y + i), Ops::mul(Ops::load(l.p2_dir + i), Ops::set1(bp.p2_step)));
+
+        V phase = Ops::load(l.phase + i);
+        M playing = Ops::eq(phase, zero);
+
+        // serving lanes keep the ball parked and count down instead
+        M serving = Ops::eq(phase, three);
+        V timer = Ops::load(l.serve_timer + i);
+        timer = Ops::select(serving, Ops::sub(timer, dt), timer);
+        M served = Ops::mand(serving, Ops::le(timer, zero));
+        V ball_dt = Ops::select(serving, zero, dt);
+
+        V vx = Ops::load(l.ball_vx + i);
+        V vy = Ops::load(l.ball_vy + i);
+        V bx = Ops::load(l.ball_x + i);
+        V by = Ops::load(l.ball_y + i);
+
+        V hits1 = zero;
+        V hits2 = zero;
+        V remaining = ball_dt;
+
+        // swept collisions: each pass moves every lane to its earliest impact
+        // (or through its remaining time) and bounces it, as in moveBall
+        for (int pass = 0; pass < BOUNCE_PASSES; pass++) {
+            V best = remaining;
+            M none = Ops::eq(zero, zero);
+
+            V t1 = Ops::div(Ops::sub(Ops::set1(bp.collision_x_1), bx), vx);
+            M hit1 = Ops::mand(playing, Ops::mand(Ops::lt(vx, zero), Ops::ge(bx, Ops::set1(bp.collision_x_1))));
+            V y1 = Ops::add(by, Ops::mul(vy, t1));
+            hit1 = Ops::mand(hit1, Ops::mand(Ops::ge(y1, Ops::sub(p1y, Ops::set1(bp.p1_half_h))), Ops::le(y1, Ops::add(p1y, Ops::set1(bp.p1_half_h)))));
+            hit1 = Ops::mand(hit1, Ops::le(t1, best));
+            best = Ops::select(hit1, t1, best);
+            none = Ops::mandnot(hit1, none);
+
+            V t2 = Ops::div(Ops::sub(Ops::set1(bp.collision_x_2), bx), vx);
+            M hit2 = Ops::mand(playing, Ops::mand(Ops::lt(zero, vx), Ops::le(bx, Ops::set1(bp.collision_x_2))));
+            V y2 = Ops::add(by, Ops::mul(vy, t2));
+            hit2 = Ops::mand(hit2, Ops::mand(Ops::ge(y2, Ops::sub(p2y, Ops::set1(bp.p2_half_h))), Ops::le(y2, Ops::add(p2y, Ops::set1(bp.p2_half_h)))));
+            hit2 = Ops::mand(hit2, Ops::mor(Ops::lt(t2, best), Ops::mand(none, Ops::le(t2, best))));
+            best = Ops::select(hit2, t2, best);
+            hit1 = Ops::mandnot(hit2, hit1);
+            none = Ops::mandnot(hit2, none);
+
+            V tu = Ops::max(Ops::div(Ops::sub(Ops::set1(bp.wall_up), by), vy), zero);
+            M up = Ops::mand(Ops::lt(zero, vy), Ops::mor(Ops::lt(tu, best), Ops::mand(none, Ops::le(tu, best))));
+            best = Ops::select(up, tu, best);
+            hit1 = Ops::mandnot(up, hit1);
+            hit2 = Ops::mandnot(up, hit2);
+            none = Ops::mandnot(up, none);
+
+            V td = Ops::max(Ops::div(Ops::sub(Ops::set1(bp.wall_down), by), vy), zero);
+            M down = Ops::mand(Ops::lt(vy, zero), Ops::mor(Ops::lt(td, best), Ops::mand(none, Ops::le(td, best))));
+            best = Ops::select(down, td, best);
+            hit1 = Ops::mandnot(down, hit1);
+            hit2 = Ops::mandnot(down, hit2);
+            up = Ops::mandnot(down, up);
+
+            bx = Ops::add(bx, Ops::mul(vx, best));
+            by = Ops::add(by, Ops::mul(vy, best));
+            remaining = Ops::sub(remaining, best);
+
+            V s, c;
+
+            sinCos<Ops>(Ops::mul(Ops::sub(by, p1y), Ops::set1(bp.angle_scale_1)), s, c);
+            bx = Ops::select(hit1, Ops::set1(bp.collision_x_1), bx);
+            vx = Ops::select(hit1, Ops::mul(c, Ops::set1(bp.reflect_1)), vx);
+            vy = Ops::select(hit1, Ops::mul(s, Ops::set1(bp.reflect_1)), vy);
+
+            sinCos<Ops>(Ops::mul(Ops::sub(by, p2y), Ops::set1(bp.angle_scale_2)), s, c);
+            bx = Ops::select(hit2, Ops::set1(bp.collision_x_2), bx);
+            vx = Ops::select(hit2, Ops::neg(Ops::mul(c, Ops::set1(bp.reflect_2))), vx);
+            vy = Ops::select(hit2, Ops::mul(s, Ops::set1(bp.reflect_2)), vy);
+
+            by = Ops::select(up, Ops::set1(bp.wall_up), by);
+            by = Ops::select(down, Ops::set1(bp.wall_down), by);
+            vy = Ops::select(Ops::mor(up, down), Ops::neg(vy), vy);
+
+            hits1 = Ops::add(hits1, Ops::ones(hit1));
+            hits2 = Ops::add(hits2, Ops::ones(hit2));
+        }
+
+        // lanes still bouncing after the last pass finish the step unobstructed
+        bx = Ops::add(bx, Ops::mul(vx, remaining));
+        by = Ops::add(by, Ops::mul(vy, remaining));
+
+        M passed1 = Ops::mand(playing, Ops::le(bx, Ops::set1(bp.passed_x_1)));
+        M passed2 = Ops::mandnot(passed1, Ops::mand(playing, Ops::ge(bx, Ops::set1(bp.passed_x_2))));
+
+        M respawn = Ops::mand(Ops::eq(phase, one), Ops::le(bx, Ops::set1(bp.out_left)));
+        respawn = Ops::mor(respawn, Ops::mand(Ops::eq(phase, two), Ops::ge(bx, Ops::set1(bp.out_right))));
+
+        phase = Ops::select(passed1, one, phase);
+        phase = Ops::select(passed2, two, phase);
+        phase = Ops::select(respawn, Ops::set1(bp.spawn_phase), phase);
+        phase = Ops::select(served, zero, phase);
+
+        timer = Ops::select(respawn, Ops::set1(bp.serve_delay), timer);
+        timer = Ops::select(served, zero, timer);
+
+        bx = Ops::select(respawn, Ops::set1(bp.spawn_x), bx);
+        by = Ops::select(respawn, Ops::set1(bp.spawn_y), by);
+        vx = Ops::select(respawn, Ops::set1(bp.spawn_vx), vx);
+        vy = Ops::select(respawn, zero, vy);
+
+        Ops::store(l.p1_y + i, p1y);
+        Ops::store(l.p2_y + i, p2y);
+        Ops::store(l.ball_x + i, bx);
+        Ops::store(l.ball_y + i, by);
+        Ops::store(l.ball_vx + i, vx);
+        Ops::store(l.ball_vy + i, vy);
+        Ops::store(l.phase + i, phase);
+        Ops::store(l.serve_timer + i, timer);
+        Ops::store(l.score_1 + i, Ops::add(Ops::load(l.score_1 + i), Ops::ones(passed2)));
+        Ops::store(l.score_2 + i, Ops::add(Ops::load(l.score_2 + i), Ops::ones(passed1)));
+        Ops::store(l.hits_1 + i, Ops::add(Ops::load(l.hits_1 + i), hits1));
+        Ops::store(l.hits_2 + i, Ops::add(Ops::load(l.hits_2 + i), hits2));
+    }
+}
+
+static BatchParams makeParams(const SimConfig &cfg, float dt)
+{
+    using namespace GameConstants;
+
+    BatchParams bp;
+
+    bp.dt = dt;
+    bp.p1_step = cfg.player_1_speed * dt;
+    bp.p2_step = cfg.player_2_speed * dt;
+
+    bp.p1_x = PLAYER_1_POS_INITIAL[0];
+    bp.p2_x = PLAYER_2_POS_INITIAL[0];
+    bp.p1_half_h = cfg.player_1_height * 0.5f;
+    bp.p2_half_h = cfg.player_2_height * 0.5f;
+
+    bp.collision_x_1 = bp.p1_x + cfg.player_1_width * 0.5f + cfg.ball_width * 0.5f;
+    bp.collision_x_2 = bp.p2_x - cfg.player_2_width * 0.5f - cfg.ball_width * 0.5f;
+    bp.angle_scale_1 = 2 * THETA_MAX / cfg.player_1_height * DEG_TO_RAD;
+    bp.angle_scale_2 = 2 * THETA_MAX / cfg.player_2_height * DEG_TO_RAD;
+    bp.reflect_1 = cfg.ball_speed_reflect_player_1;
+    bp.reflect_2 = cfg.ball_speed_reflect_player_2;
+
+    bp.passed_x_1 = bp.p1_x - cfg.player_1_width * BALL_PASS_THROUGH_LIM;
+    bp.passed_x_2 = bp.p2_x - cfg.player_2_width * BALL_PASS_THROUGH_LIM;
+    bp.out_left = cfg.bound_left - cfg.ball_width * 0.5f;
+    bp.out_right = cfg.bound_right + cfg.ball_width * 0.5f;
+
+    bp.wall_up = cfg.bound_up - cfg.ball_height * 0.5f;
+    bp.wall_down = cfg.bound_down + cfg.ball_height * 0.5f;
+
+    bp.spawn_x = BALL_POS_INITIAL[0];
+    bp.spawn_y = BALL_POS_INITIAL[1];
+    bp.spawn_vx = cfg.ball_speed_initial;
+    bp.spawn_phase = cfg.serve_delay > 0.0f ? 3.0f : 0.0f;
+    bp.serve_delay = cfg.serve_delay;
+
+    return bp;
+}
+
+BatchSimulator::BatchSimulator(size_t num_matches, const SimConfig &config) : num_matches(num_matches), config(config)
+{
+    // pad to the widest kernel so vector loops never need a remainder pass
+    padded_size = (num_matches + 7) & ~(size_t)7;
+
+    for (std::vector<float> *v : { &ball_x, &ball_y, &ball_vx, &ball_vy, &p1_y, &p2_y, &p1_dir, &p2_dir,
+                                   &phase, &serve_timer, &score_1, &score_2, &hits_1, &hits_2 }) {
+        v->resize(padded_size);
+    }
+
+    reset();
+}
+
+void BatchSimulator::reset()
+{
+    SimState initial;
+    Simulation::init(initial, config);
+
+    for (size_t i = 0; i < padded_size; i++) {
+        ball_x[i] = initial.ball.position.x;
+        ball_y[i] = initial.ball.position.y;
+        ball_vx[i] = initial.ball.speed.x;
+        ball_vy[i] = initial.ball.speed.y;
+        p1_y[i] = initial.p1.position.y;
+        p2_y[i] = initial.p2.position.y;
+        p1_dir[i] = 0.0f;
+        p2_dir[i] = 0.0f;
+        phase[i] = (float)initial.phase;
+        serve_timer[i] = initial.phase_timer;
+        score_1[i] = 0.0f;
+        score_2[i] = 0.0f;
+        hits_1[i] = 0.0f;
+        hits_2[i] = 0.0f;
+    }
+
+    tick = 0;
+}
+
+void BatchSimulator::setKernel(BatchKernel k)
+{
+    kernel = resolveKernel(k);
+}
+
+BatchKernel BatchSimulator::resolveKernel(BatchKernel k)
+{
+    switch (k) {
+    case BatchKernel::Scalar:
+        return BatchKernel::Scalar;
+#if defined(BATCH_HAVE_SSE)
+    case BatchKernel::SSE:
+        return BatchKernel::SSE;
+#endif
+#if defined(__AVX2__)
+    case BatchKernel::AVX2:
+        return BatchKernel::AVX2;
+#endif
+    default:
+        break;
+    }
+
+    // Auto, or a kernel that wasn't compiled in: the widest one that was
+#if defined(__AVX2__)
+    return BatchKernel::AVX2;
+#elif defined(BATCH_HAVE_SSE)
+    return BatchKernel::SSE;
+#else
+    return BatchKernel::Scalar;
+#endif
+}
+
+const char* BatchSimulator::getKernelName(BatchKernel k)
+{
+    switch (resolveKernel(k)) {
+    case BatchKernel::SSE: return "sse";
+    case BatchKernel::AVX2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+void BatchSimulator::setInputs(size_t match, const SimInputs &inputs)
+{
+    p1_dir[match] = (float)inputs.p1_dir;
+    p2_dir[match] = (float)inputs.p2_dir;
+}
+
+void BatchSimulator::setAI(bool enabled, const InterceptAIConfig &ai_config, uint64_t seed)
+{
+    ai_enabled = enabled;
+    this->ai_config = ai_config;
+    ai_seed = seed;
+}
+
+void BatchSimulator::driveAI()
+{
+    const MatchParams params = PaddleKernels::makeMatchParams(config);
+
+    // everything but the ball and paddle heights is the same for all matches
+    InterceptView view_1;
+    view_1.paddle_height = config.player_1_height;
+    view_1.face_x = GameConstants::PLAYER_1_POS_INITIAL[0] + params.p1.half_width + params.p1.half_ball_width;
+    view_1.far_face_x = GameConstants::PLAYER_2_POS_INITIAL[0] - params.p2.half_width - params.p2.half_ball_width;
+    view_1.wall_down = config.bound_down + config.ball_height * 0.5f;
+    view_1.wall_up = config.bound_up - config.ball_height * 0.5f;
+    view_1.dir = PaddleKernel_player_1::DIR;
+
+    InterceptView view_2 = view_1;
+    view_2.paddle_height = config.player_2_height;
+    view_2.face_x = view_1.far_face_x;
+    view_2.far_face_x = view_1.face_x;
+    view_2.dir = PaddleKernel_player_2::DIR;
+
+    for (size_t i = 0; i < num_matches; i++) {
+        view_1.ball_x = view_2.ball_x = ball_x[i];
+        view_1.ball_y = view_2.ball_y = ball_y[i];
+        view_1.ball_vx = view_2.ball_vx = ball_vx[i];
+        view_1.ball_vy = view_2.ball_vy = ball_vy[i];
+        view_1.paddle_y = p1_y[i];
+        view_2.paddle_y = p2_y[i];
+
+        uint64_t seed = InterceptAI::tickSeed(ai_seed + i * 0x9E3779B97F4A7C15ull, tick);
+        p1_dir[i] = (float)InterceptAI::decide(view_1, ai_config, seed);
+        p2_dir[i] = (float)InterceptAI::decide(view_2, ai_config, ~seed);
+    }
+}
+
+void BatchSimulator::step(float dt)
+{
+    if (ai_enabled) driveAI();
+
+    BatchLanes lanes(*this);
+    BatchParams bp = makeParams(config, dt);
+
+    switch (kernel) {
+#if defined(__AVX2__)
+    case BatchKernel::AVX2:
+        stepKernel<Avx2Ops>(lanes, bp, 0, padded_size);
+        break;
+#endif
+#if defined(BATCH_HAVE_SSE)
+    case BatchKernel::SSE:
+        stepKernel<SseOps>(lanes, bp, 0, padded_size);
+        break;
+#endif
+    default:
+        stepKernel<ScalarOps>(lanes, bp, 0, num_matches);
+        break;
+    }
+
+    tick++;
+}
+
+BatchStats BatchSimulator::run(uint64_t ticks, float dt)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t t = 0; t < ticks; t++) {
+        step(dt);
+    }
+
+    BatchStats stats;
+    stats.ticks = ticks;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats.seconds > 0.0) {
+        stats.match_ticks_per_second = (double)ticks * (double)num_matches / stats.seconds;
+    }
+    return stats;
+}
+
+void BatchSimulator::getMatch(size_t match, SimState &state) const
+{
+    Simulation::init(state, config);
+
+    state.p1.position.y = p1_y[match];
+    state.p1.speed.y = p1_dir[match] * config.player_1_speed;
+    state.p2.position.y = p2_y[match];
+    state.p2.speed.y = p2_dir[match] * config.player_2_speed;
+
+    state.ball.position = { ball_x[match], ball_y[match] };
+    state.ball.speed = { ball_vx[match], ball_vy[match] };
+
+    state.phase = (MatchPhase)(int)phase[match];
+    state.phase_timer = serve_timer[match];
+
+    state.score_player_1 = (uint32_t)score_1[match];
+    state.score_player_2 = (uint32_t)score_2[match];
+    state.tick = tick;
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#ifndef BATCH_SIMULATOR_HPP
+#define BATCH_SIMULATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Simulation.hpp"
+#include "InterceptAI.hpp"
+
+enum class BatchKernel
+{
+    Auto,
+    Scalar,
+    SSE,
+    AVX2
+};
+
+struct BatchStats
+{
+    uint64_t ticks = 0;
+    double seconds = 0.0;
+    double match_ticks_per_second = 0.0;
+};
+
+// Steps many independent matches at once. State is kept as structure-of-arrays
+// so the per-tick kernel runs 8 (AVX2) or 4 (SSE) matches per instruction.
+// All matches share one SimConfig; paddle hits use a polynomial sin/cos, so
+// results track Simulation::step closely but not bit for bit. Collisions are
+// swept like Simulation::step, with up to 3 bounces per match per tick.
+class BatchSimulator
+{
+public:
+    explicit BatchSimulator(size_t num_matches, const SimConfig &config = SimConfig());
+
+    void reset();
+    // Kernels that weren't compiled in fall back to the widest one that was;
+    // getKernel and getKernelName report the kernel that actually runs.
+    void setKernel(BatchKernel kernel);
+    BatchKernel getKernel() const { return kernel; }
+    static BatchKernel resolveKernel(BatchKernel kernel);
+    static const char* getKernelName(BatchKernel kernel);
+
+    void setInputs(size_t match, const SimInputs &inputs);
+
+    // Lets InterceptAI play both paddles of every match, deciding before each
+    // step; setInputs has no effect while it's on.
+    void setAI(bool enabled, const InterceptAIConfig &ai_config = InterceptAIConfig(), uint64_t seed = 1);
+
+    void step(float dt);
+
+    // Runs the given number of ticks and measures throughput.
+    BatchStats run(uint64_t ticks, float dt);
+
+    size_t size() const { return num_matches; }
+    const SimConfig& getConfig() const { return config; }
+
+    void getMatch(size_t match, SimState &state) const;
+    uint32_t getScore_player_1(size_t match) const { return (uint32_t)score_1[match]; }
+    uint32_t getScore_player_2(size_t match) const { return (uint32_t)score_2[match]; }
+    uint32_t getHits_player_1(size_t match) const { return (uint32_t)hits_1[match]; }
+    uint32_t getHits_player_2(size_t match) const { return (uint32_t)hits_2[match]; }
+
+    // just what drawing needs, without building a whole SimState
+    SimVec2 getBallPosition(size_t match) const { return { ball_x[match], ball_y[match] }; }
+    float getPaddleY_player_1(size_t match) const { return p1_y[match]; }
+    float getPaddleY_player_2(size_t match) const { return p2_y[match]; }
+
+private:
+    friend struct BatchLanes;
+
+    void driveAI();
+
+    size_t num_matches = 0;
+    size_t padded_size = 0;
+    uint64_t tick = 0;
+
+    SimConfig config;
+    BatchKernel kernel = resolveKernel(BatchKernel::Auto);
+
+    bool ai_enabled = false;
+    InterceptAIConfig ai_config;
+    uint64_t ai_seed = 1;
+
+    std::vector<float> ball_x;
+    std::vector<float> ball_y;
+    std::vector<float> ball_vx;
+    std::vector<float> ball_vy;
+
+    std::vector<float> p1_y;
+    std::vector<float> p2_y;
+    std::vector<float> p1_dir;
+    std::vector<float> p2_dir;
+
+    // MatchPhase as a float (0 = rally, 1/2 = ball got past player 1/2, 3 = serving).
+    // Counters are kept as floats so every lane stays in one register type.
+    std::vector<float> phase;
+    std::vector<float> serve_timer;
+    std::vector<float> score_1;
+    std::vector<float> score_2;
+    std::vector<float> hits_1;
+    std::vector<float> hits_2;
+};
+
+#endif
\ No newline at end of file
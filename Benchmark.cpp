@@ -0,0 +1,999 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BatchSimulator.hpp"
+#include "MatchRunner.hpp"
+#include "PaddleKernel.hpp"
+#include "Replay.hpp"
+#include "Rollback.hpp"
+#include "Spectator.hpp"
+
+#if !defined(SIMPLEPONG_HEADLESS)
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "Game.hpp"
+#include "GLState.hpp"
+#include "StressWorld.hpp"
+#endif
+
+// Standalone benchmark executable. Simulation benchmarks always run; GL ones
+// need a context, which also works headless under Mesa's software renderer:
+//
+//     xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ./benchmark --out results.json
+//
+// Options: --out <file>  --frames <n>  --no-gl  --verify
+//
+// Built with SIMPLEPONG_HEADLESS defined, it needs only the simulation library
+// and runs just the benchmarks that don't touch GL.
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct BenchResult
+    {
+        std::string name;
+        uint64_t iterations = 0;
+        double ns_per_op = 0.0;
+        std::vector<std::pair<std::string, double>> extra;
+    };
+
+    struct BenchOptions
+    {
+        const char *out_path = "benchmark_results.json";
+        int frames = 1000;
+        bool gl = true;
+        bool verify_only = false;
+    };
+
+    volatile uint64_t sink;
+
+    // every operator new in the process, so a benchmark can check that its
+    // steady state doesn't allocate; match runner workers allocate too
+    std::atomic<uint64_t> heap_allocations{ 0 };
+
+    double elapsedNs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    template <class F>
+    BenchResult measure(const char *name, uint64_t iterations, F &&body)
+    {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            body(i);
+        }
+
+        BenchResult result;
+        result.name = name;
+        result.iterations = iterations;
+        result.ns_per_op = elapsedNs(start) / (double)iterations;
+        return result;
+    }
+
+#if !defined(SIMPLEPONG_HEADLESS)
+    double percentile(const std::vector<double> &sorted, double p)
+    {
+        if (sorted.empty()) return 0.0;
+        size_t index = (size_t)(p * (double)(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+#endif
+
+    void printResult(const BenchResult &result)
+    {
+        printf("%-32s %12.1f ns/op  (%llu iterations)\n", result.name.c_str(), result.ns_per_op, (unsigned long long)result.iterations);
+        for (const auto &kv : result.extra) {
+            printf("    %-28s %12.3f\n", kv.first.c_str(), kv.second);
+        }
+    }
+}
+
+// GCC inlines these into callers and then sees free() on memory from
+// operator new, which is exactly what this pair is meant to do
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size)
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+// The per-player paddle functions PaddleKernel replaced, kept verbatim as the
+// reference for --verify and the paddle_hit_legacy benchmark.
+namespace Legacy {
+
+    constexpr float DEG_TO_RAD = 0.01745329251994329577f;
+
+    float sweepPaddle(const SimState &state, const SimBody &p, float face_x, float direction, float max_t)
+    {
+        const SimBody &ball = state.ball;
+
+        if (state.phase != MatchPhase::Rally || ball.speed.x * direction <= 0.0f) return -1.0f;
+        if ((face_x - ball.position.x) * direction < 0.0f) return -1.0f;
+
+        float t = (face_x - ball.position.x) / ball.speed.x;
+        if (t > max_t) return -1.0f;
+
+        float y = ball.position.y + ball.speed.y * t;
+        if (y < p.position.y - p.height * 0.5f || y > p.position.y + p.height * 0.5f) return -1.0f;
+
+        return t;
+    }
+
+    float faceX_player_1(const SimState &state)
+    {
+        return state.p1.position.x + state.p1.width * 0.5f + state.ball.width * 0.5f;
+    }
+
+    float faceX_player_2(const SimState &state)
+    {
+        return state.p2.position.x - state.p2.width * 0.5f - state.ball.width * 0.5f;
+    }
+
+    float sweep_player_1(const SimState &state, float max_t)
+    {
+        return sweepPaddle(state, state.p1, faceX_player_1(state), -1.0f, max_t);
+    }
+
+    float sweep_player_2(const SimState &state, float max_t)
+    {
+        return sweepPaddle(state, state.p2, faceX_player_2(state), 1.0f, max_t);
+    }
+
+    void updateBallDirection_player_1(SimState &state)
+    {
+        constexpr float theta_max = 75.0f;
+
+        float d = state.ball.position.y - state.p1.position.y;
+
+        float angle_deg = 2 * theta_max / state.p1.height * d;
+        float angle = angle_deg * DEG_TO_RAD;
+
+        SimVec2 straight_vec = { state.config.ball_speed_reflect_player_1, 0.0f };
+
+        float r_x = std::cos(angle) * straight_vec.x - std::sin(angle) * straight_vec.y;
+        float r_y = std::sin(angle) * straight_vec.x + std::cos(angle) * straight_vec.y;
+
+        state.ball.speed = { r_x, r_y };
+    }
+
+    void updateBallDirection_player_2(SimState &state)
+    {
+        constexpr float theta_max = 75.0f;
+
+        float d = state.ball.position.y - state.p2.position.y;
+
+        float angle_deg = 2 * theta_max / state.p2.height * d;
+        float angle = angle_deg * DEG_TO_RAD;
+
+        SimVec2 straight_vec = { -state.config.ball_speed_reflect_player_2, 0.0f };
+
+        float r_x = std::cos(-angle) * straight_vec.x - std::sin(-angle) * straight_vec.y;
+        float r_y = std::sin(-angle) * straight_vec.x + std::cos(-angle) * straight_vec.y;
+
+        state.ball.speed = { r_x, r_y };
+    }
+
+    void bounce_player_1(SimState &state)
+    {
+        state.ball.position.x = faceX_player_1(state);
+        updateBallDirection_player_1(state);
+    }
+
+    void bounce_player_2(SimState &state)
+    {
+        state.ball.position.x = faceX_player_2(state);
+        updateBallDirection_player_2(state);
+    }
+
+    bool playerScored_player_1(const SimBody &player, const SimState &state)
+    {
+        constexpr float ball_pass_through_lim = 0.6f;
+        return state.ball.position.x <= player.position.x - player.width * ball_pass_through_lim;
+    }
+
+    bool playerScored_player_2(const SimBody &player, const SimState &state)
+    {
+        constexpr float ball_pass_through_lim = 0.6f;
+        return state.ball.position.x >= player.position.x - player.width * ball_pass_through_lim;
+    }
+
+    bool isBallOutOfBoundsLeft(const SimState &state)
+    {
+        return state.ball.position.x + state.ball.width * 0.5f <= state.config.bound_left;
+    }
+
+    bool isBallOutOfBoundsRight(const SimState &state)
+    {
+        return state.ball.position.x - state.ball.width * 0.5f >= state.config.bound_right;
+    }
+};
+
+// Random states around both paddles: balls in and out of reach, moving either
+// way, paddles anywhere, and every phase.
+static SimState randomPaddleState(uint64_t &rng)
+{
+    auto unit = [&rng]() { return (float)(MatchControllers::nextRandom(rng) >> 40) / (float)(1u << 24); };
+
+    SimState state;
+    Simulation::init(state);
+
+    state.p1.position.y = -1.8f + 3.6f * unit();
+    state.p2.position.y = -1.8f + 3.6f * unit();
+    state.ball.position = { -2.1f + 4.2f * unit(), -2.0f + 4.0f * unit() };
+    state.ball.speed = { -4.0f + 8.0f * unit(), -4.0f + 8.0f * unit() };
+    state.phase = (MatchPhase)(MatchControllers::nextRandom(rng) % 4 == 0 ? 1 + MatchControllers::nextRandom(rng) % 3 : 0);
+
+    return state;
+}
+
+static bool sameBits(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static bool sameBall(const SimBody &a, const SimBody &b)
+{
+    return sameBits(a.position.x, b.position.x) && sameBits(a.position.y, b.position.y) &&
+           sameBits(a.speed.x, b.speed.x) && sameBits(a.speed.y, b.speed.y);
+}
+
+// Checks that PaddleKernel matches the legacy functions bit for bit.
+static uint64_t verifyPaddleKernel(uint64_t samples, uint64_t &hits)
+{
+    const MatchParams &params = PaddleKernels::DEFAULT_MATCH_PARAMS;
+
+    uint64_t mismatches = 0;
+    uint64_t rng = 11;
+    hits = 0;
+
+    for (uint64_t i = 0; i < samples; i++) {
+        SimState state = randomPaddleState(rng);
+        float max_t = (float)(MatchControllers::nextRandom(rng) >> 40) / (float)(1u << 24);
+
+        float t1 = PaddleKernel_player_1::sweep(state, params.p1, max_t);
+        float t2 = PaddleKernel_player_2::sweep(state, params.p2, max_t);
+
+        bool same = sameBits(t1, Legacy::sweep_player_1(state, max_t)) &&
+                    sameBits(t2, Legacy::sweep_player_2(state, max_t)) &&
+                    PaddleKernel_player_1::passed(state, params.p1) == Legacy::playerScored_player_1(state.p1, state) &&
+                    PaddleKernel_player_2::passed(state, params.p2) == Legacy::playerScored_player_2(state.p2, state) &&
+                    PaddleKernel_player_1::outOfBounds(state, params.p1) == Legacy::isBallOutOfBoundsLeft(state) &&
+                    PaddleKernel_player_2::outOfBounds(state, params.p2) == Legacy::isBallOutOfBoundsRight(state);
+
+        // bounce every sample off both paddles, hit or not, to cover all angles
+        SimState kernel = state, legacy = state;
+        PaddleKernel_player_1::bounce(kernel, params.p1);
+        Legacy::bounce_player_1(legacy);
+        same = same && sameBall(kernel.ball, legacy.ball);
+
+        kernel = state;
+        legacy = state;
+        PaddleKernel_player_2::bounce(kernel, params.p2);
+        Legacy::bounce_player_2(legacy);
+        same = same && sameBall(kernel.ball, legacy.ball);
+
+        hits += (t1 >= 0.0f) + (t2 >= 0.0f);
+        mismatches += !same;
+    }
+
+    return mismatches;
+}
+
+static void benchSimulationStep(std::vector<BenchResult> &results)
+{
+    SimState state;
+    Simulation::init(state, Simulation::headlessConfig());
+    uint64_t rng = 1;
+    const float dt = 1.0f / GameConstants::SIM_TICK_RATE;
+
+    uint64_t events = 0;
+    BenchResult result = measure("simulation_step", 10000000, [&](uint64_t) {
+        events += Simulation::step(state, MatchControllers::trackBall(state, rng), dt);
+    });
+    sink = events;
+
+    results.push_back(result);
+}
+
+static void benchCollisions(std::vector<BenchResult> &results)
+{
+    constexpr size_t NUM_SAMPLES = 1024;
+
+    SimState state;
+    Simulation::init(state);
+
+    // a mix of balls that reach a paddle or wall within the sweep window and ones that don't
+    constexpr float SWEEP_T = 0.25f;
+
+    std::vector<SimBody> balls(NUM_SAMPLES, state.ball);
+    uint64_t rng = 7;
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        float u = (float)(MatchControllers::nextRandom(rng) >> 40) / (float)(1u << 24);
+        float v = (float)(MatchControllers::nextRandom(rng) >> 40) / (float)(1u << 24);
+        balls[i].position = { -1.6f + 3.2f * u, -2.0f + 4.0f * v };
+        balls[i].speed = { (i & 1) ? 2.5f : -2.5f, 1.0f };
+    }
+
+    uint64_t hits = 0;
+
+    results.push_back(measure("collision_player_1", 20000000, [&](uint64_t i) {
+        state.ball = balls[i & (NUM_SAMPLES - 1)];
+        hits += Simulation::sweep_player_1(state, SWEEP_T) >= 0.0f;
+    }));
+
+    results.push_back(measure("collision_player_2", 20000000, [&](uint64_t i) {
+        state.ball = balls[i & (NUM_SAMPLES - 1)];
+        hits += Simulation::sweep_player_2(state, SWEEP_T) >= 0.0f;
+    }));
+
+    results.push_back(measure("collision_walls", 20000000, [&](uint64_t i) {
+        state.ball = balls[i & (NUM_SAMPLES - 1)];
+        hits += Simulation::sweep_up(state, SWEEP_T) >= 0.0f;
+        hits += Simulation::sweep_down(state, SWEEP_T) >= 0.0f;
+    }));
+
+    sink = hits;
+}
+
+static void benchPaddleKernel(std::vector<BenchResult> &results)
+{
+    constexpr size_t NUM_SAMPLES = 1024;
+    constexpr float MAX_T = 1.0f;
+
+    // only states where the ball does reach a paddle, so every op is a hit
+    std::vector<SimState> samples;
+    uint64_t rng = 5;
+    while (samples.size() < NUM_SAMPLES) {
+        SimState state = randomPaddleState(rng);
+        if (Legacy::sweep_player_1(state, MAX_T) >= 0.0f || Legacy::sweep_player_2(state, MAX_T) >= 0.0f) samples.push_back(state);
+    }
+
+    float total = 0.0f;
+
+    results.push_back(measure("paddle_hit_legacy", 20000000, [&](uint64_t i) {
+        SimState state = samples[i & (NUM_SAMPLES - 1)];
+        if (Legacy::sweep_player_1(state, MAX_T) >= 0.0f) Legacy::bounce_player_1(state);
+        else if (Legacy::sweep_player_2(state, MAX_T) >= 0.0f) Legacy::bounce_player_2(state);
+        total += state.ball.speed.y;
+    }));
+
+    const MatchParams &params = PaddleKernels::DEFAULT_MATCH_PARAMS;
+
+    results.push_back(measure("paddle_hit_kernel", 20000000, [&](uint64_t i) {
+        SimState state = samples[i & (NUM_SAMPLES - 1)];
+        if (PaddleKernel_player_1::sweep(state, params.p1, MAX_T) >= 0.0f) PaddleKernel_player_1::bounce(state, params.p1);
+        else if (PaddleKernel_player_2::sweep(state, params.p2, MAX_T) >= 0.0f) PaddleKernel_player_2::bounce(state, params.p2);
+        total += state.ball.speed.y;
+    }));
+
+    uint64_t hits = 0;
+    uint64_t mismatches = verifyPaddleKernel(1000000, hits);
+    results.back().extra.push_back({ "mismatches_vs_legacy", (double)mismatches });
+
+    sink = (uint64_t)total + hits;
+}
+
+static void benchBatchSimulator(std::vector<BenchResult> &results)
+{
+    constexpr size_t NUM_MATCHES = 16384;
+    constexpr uint64_t TICKS = 2000;
+
+    // the same matches again with InterceptAI deciding every paddle, every tick
+    const std::pair<BatchKernel, bool> runs[] = {
+        { BatchKernel::Scalar, false },
+        { BatchKernel::Auto, false },
+        { BatchKernel::Auto, true }
+    };
+
+    for (const auto &run : runs) {
+        BatchSimulator batch(NUM_MATCHES, Simulation::headlessConfig());
+        batch.setKernel(run.first);
+        batch.setAI(run.second);
+
+        BatchStats stats = batch.run(TICKS, 1.0f / GameConstants::SIM_TICK_RATE);
+
+        BenchResult result;
+        result.name = std::string("batch_step_") + BatchSimulator::getKernelName(run.first) + (run.second ? "_intercept_ai" : "");
+        result.iterations = stats.ticks * NUM_MATCHES;
+        result.ns_per_op = stats.seconds * 1e9 / (double)result.iterations;
+        result.extra.push_back({ "match_ticks_per_second", stats.match_ticks_per_second });
+        results.push_back(result);
+    }
+}
+
+static void benchMatchRunner(std::vector<BenchResult> &results)
+{
+    std::vector<MatchSpec> specs(2048);
+    for (size_t i = 0; i < specs.size(); i++) {
+        specs[i].seed = i + 1;
+    }
+
+    MatchRunner runner;
+    std::vector<MatchResult> match_results;
+
+    for (MatchController controller : { MatchControllers::trackBall, MatchControllers::interceptBall }) {
+        runner.setController(controller);
+        RunnerStats stats = runner.run(specs, match_results);
+
+        BenchResult result;
+        result.name = controller == MatchControllers::trackBall ? "match_runner" : "match_runner_intercept_ai";
+        result.iterations = stats.ticks;
+        result.ns_per_op = stats.ticks ? stats.seconds * 1e9 / (double)stats.ticks : 0.0;
+        result.extra.push_back({ "threads", (double)runner.getThreadCount() });
+        result.extra.push_back({ "matches_per_second", (double)stats.matches / stats.seconds });
+        result.extra.push_back({ "steals", (double)stats.steals });
+        results.push_back(result);
+    }
+
+    SimState state;
+    Simulation::init(state, Simulation::headlessConfig());
+    uint64_t rng = 1;
+    int64_t dirs = 0;
+
+    // decisions only, on states sampled from a running match
+    std::vector<SimState> states(1024);
+    for (SimState &sample : states) {
+        for (int i = 0; i < 17; i++) Simulation::step(state, MatchControllers::trackBall(state, rng), 1.0f / GameConstants::SIM_TICK_RATE);
+        sample = state;
+    }
+
+    results.push_back(measure("intercept_ai_decision", 10000000, [&](uint64_t i) {
+        SimInputs inputs = MatchControllers::interceptBall(states[i & 1023], rng);
+        dirs += inputs.p1_dir + inputs.p2_dir;
+    }));
+    sink = (uint64_t)dirs;
+}
+
+static void benchReplayPlayback(std::vector<BenchResult> &results)
+{
+    constexpr size_t NUM_REPLAYS = 256;
+    const float dt = 1.0f / GameConstants::SIM_TICK_RATE;
+
+    std::vector<std::vector<uint8_t>> corpus(NUM_REPLAYS);
+    size_t total_bytes = 0;
+
+    for (size_t i = 0; i < NUM_REPLAYS; i++) {
+        MatchSpec spec;
+        spec.seed = i + 1;
+
+        ReplayRecorder recorder;
+        playMatch(spec, MatchControllers::trackBall, dt, &recorder);
+        corpus[i] = recorder.getData();
+        total_bytes += corpus[i].size();
+    }
+
+    uint64_t ticks = 0;
+    size_t matching = 0;
+
+    auto start = Clock::now();
+    for (const std::vector<uint8_t> &data : corpus) {
+        ReplayView view;
+        SimState state;
+        if (Replay::parse(data.data(), data.size(), view) && Replay::simulate(view, state)) matching++;
+        ticks += state.tick;
+    }
+    double ns = elapsedNs(start);
+
+    BenchResult result;
+    result.name = "replay_playback";
+    result.iterations = ticks;
+    result.ns_per_op = ns / (double)ticks;
+    result.extra.push_back({ "matches_per_second", (double)NUM_REPLAYS * 1e9 / ns });
+    result.extra.push_back({ "bytes_per_match", (double)total_bytes / (double)NUM_REPLAYS });
+    result.extra.push_back({ "matching", (double)matching });
+    results.push_back(result);
+}
+
+static void benchRollback(std::vector<BenchResult> &results)
+{
+    SimState state;
+    Simulation::init(state);
+    SimSnapshot snapshot;
+
+    results.push_back(measure("snapshot_save_restore", 20000000, [&](uint64_t i) {
+        state.tick = i;
+        Simulation::saveSnapshot(state, snapshot);
+        Simulation::restoreSnapshot(state, snapshot);
+    }));
+    sink = state.tick;
+
+    // two peers over a loopback link 6 ticks (25 ms) each way, driven by bots
+    constexpr uint32_t DELAY_TICKS = 6;
+    constexpr uint64_t TICKS = 200000;
+    const float dt = 1.0f / GameConstants::SIM_TICK_RATE;
+
+    LoopbackTransport link_a, link_b;
+    LoopbackTransport::connect(link_a, link_b, DELAY_TICKS);
+
+    RollbackSession peer_a, peer_b;
+    peer_a.begin(Simulation::headlessConfig(), 1, &link_a, dt);
+    peer_b.begin(Simulation::headlessConfig(), 2, &link_b, dt);
+
+    uint64_t rng_a = 1, rng_b = 2;
+    uint32_t events = 0;
+
+    BenchResult result = measure("rollback_loopback_tick", TICKS, [&](uint64_t) {
+        peer_a.advance(MatchControllers::trackBall(peer_a.getState(), rng_a).p1_dir, events);
+        peer_b.advance(MatchControllers::trackBall(peer_b.getState(), rng_b).p2_dir, events);
+    });
+
+    const RollbackStats &stats = peer_a.getStats();
+    result.extra.push_back({ "rollbacks", (double)stats.rollbacks });
+    result.extra.push_back({ "resimulated_ticks_per_rollback", stats.rollbacks ? (double)stats.resimulated_ticks / (double)stats.rollbacks : 0.0 });
+    result.extra.push_back({ "max_rollback_ticks", (double)stats.max_rollback_ticks });
+    result.extra.push_back({ "stalls", (double)stats.stalls });
+    results.push_back(result);
+}
+
+static void benchSpectatorStream(std::vector<BenchResult> &results)
+{
+    // loopback harness: one match fanned out to many viewers with assorted
+    // latencies and some packet loss, each viewer acking what it decoded
+    constexpr int NUM_CLIENTS = 256;
+    constexpr uint32_t TICKS = 20000;
+    constexpr uint32_t LOSS_PERCENT = 5;
+    const float dt = 1.0f / GameConstants::SIM_TICK_RATE;
+
+    struct Viewer
+    {
+        SpectatorClient client;
+        uint32_t latency = 0;
+        std::deque<std::pair<uint32_t, std::vector<uint8_t>>> in_flight;
+        std::deque<std::pair<uint32_t, uint32_t>> acks;
+    };
+
+    SpectatorServer server;
+    std::vector<Viewer> viewers(NUM_CLIENTS);
+    for (int i = 0; i < NUM_CLIENTS; i++) {
+        server.addClient();
+        viewers[i].latency = (uint32_t)i % 8;
+    }
+
+    SimState state;
+    Simulation::init(state, Simulation::headlessConfig());
+
+    std::vector<SpectatorFrame> sent(TICKS + 1);
+    uint64_t rng = 3;
+
+    double encode_ns = 0.0, decode_ns = 0.0;
+    uint64_t encodes = 0, decodes = 0, bytes = 0, packets = 0, mismatches = 0;
+
+    for (uint32_t now = 0; now < TICKS; now++) {
+        Simulation::step(state, MatchControllers::trackBall(state, rng), dt);
+        SpectatorCodec::quantize(state, sent[state.tick]);
+
+        auto start = Clock::now();
+        server.publish(state);
+        encode_ns += elapsedNs(start);
+        encodes += server.getEncodesLastPublish();
+
+        for (int i = 0; i < NUM_CLIENTS; i++) {
+            Viewer &viewer = viewers[i];
+
+            size_t size;
+            const uint8_t *data = server.getPacket(i, size);
+            bytes += size;
+            packets++;
+
+            if (MatchControllers::nextRandom(rng) % 100 >= LOSS_PERCENT) {
+                viewer.in_flight.push_back({ now + viewer.latency, std::vector<uint8_t>(data, data + size) });
+            }
+
+            while (!viewer.in_flight.empty() && viewer.in_flight.front().first <= now) {
+                const std::vector<uint8_t> &packet = viewer.in_flight.front().second;
+
+                start = Clock::now();
+                bool ok = viewer.client.receive(packet.data(), packet.size());
+                decode_ns += elapsedNs(start);
+                decodes++;
+
+                if (ok) {
+                    const SpectatorFrame &frame = viewer.client.getFrame();
+                    if (memcmp(frame.values, sent[frame.tick].values, sizeof(frame.values)) != 0) mismatches++;
+                    viewer.acks.push_back({ now + viewer.latency, viewer.client.getAckTick() });
+                }
+                viewer.in_flight.pop_front();
+            }
+
+            while (!viewer.acks.empty() && viewer.acks.front().first <= now) {
+                server.acknowledge(i, viewer.acks.front().second);
+                viewer.acks.pop_front();
+            }
+        }
+    }
+
+    BenchResult encode_result;
+    encode_result.name = "spectator_encode";
+    encode_result.iterations = encodes;
+    encode_result.ns_per_op = encode_ns / (double)encodes;
+    encode_result.extra.push_back({ "viewers", (double)NUM_CLIENTS });
+    encode_result.extra.push_back({ "publish_ns_per_viewer", encode_ns / (double)packets });
+    encode_result.extra.push_back({ "bytes_per_viewer_tick", (double)bytes / (double)packets });
+    encode_result.extra.push_back({ "mismatches", (double)mismatches });
+    results.push_back(encode_result);
+
+    BenchResult decode_result;
+    decode_result.name = "spectator_decode";
+    decode_result.iterations = decodes;
+    decode_result.ns_per_op = decode_ns / (double)decodes;
+    results.push_back(decode_result);
+}
+
+#if !defined(SIMPLEPONG_HEADLESS)
+
+static void benchStressWorld(std::vector<BenchResult> &results)
+{
+    constexpr uint64_t TICKS = 500;
+    const float dt = 1.0f / GameConstants::SIM_TICK_RATE;
+
+    // the ball size shrinks as the count grows, so the field stays equally
+    // crowded and ns per ball should stay roughly flat. The speed shrinks with
+    // it, keeping ball_speed * dt under half the ball size as StressWorld needs.
+    for (uint32_t num_balls : { 1000u, 4000u, 16000u }) {
+        StressConfig config;
+        float shrink = std::sqrt(1000.0f / (float)num_balls);
+        config.num_balls = num_balls;
+        config.ball_size *= shrink;
+        config.ball_speed *= shrink;
+
+        StressWorld world;
+        world.init(config, StressWorld::defaultObstacles());
+
+        auto start = Clock::now();
+        for (uint64_t t = 0; t < TICKS; t++) {
+            world.step(dt);
+        }
+
+        const StressStats &stats = world.getStats();
+
+        BenchResult result;
+        result.name = "stress_step_" + std::to_string(num_balls);
+        result.iterations = TICKS * num_balls;
+        result.ns_per_op = elapsedNs(start) / (double)result.iterations;
+        result.extra.push_back({ "pair_tests_per_ball", (double)stats.pair_tests / (double)result.iterations });
+        result.extra.push_back({ "cell_moves_per_tick", (double)stats.cell_moves / (double)TICKS });
+        results.push_back(result);
+    }
+}
+
+static void benchBufferUploads(std::vector<BenchResult> &results)
+{
+    constexpr size_t NUM_RECTS = 10000;
+
+    std::vector<Rectangle2D> rects(NUM_RECTS, Rectangle2D(0.1f, 0.1f, { 0.0f, 0.0f }));
+
+    BufferHandler static_buffers;
+    static_buffers.generateBuffers();
+
+    BenchResult static_result = measure("buffer_static_upload_10k", 200, [&](uint64_t) {
+        static_buffers.clear();
+        static_buffers.addShapes(rects);
+        static_buffers.loadDataToGPU();
+    });
+    glFinish();
+    results.push_back(static_result);
+
+    std::vector<GLfloat> instances(NUM_RECTS * 4, 0.5f);
+
+    BenchResult stream_result = measure("buffer_stream_instances_10k", 2000, [&](uint64_t) {
+        static_buffers.loadInstanceData(instances.data(), (GLuint)instances.size());
+        static_buffers.endFrame();
+    });
+    glFinish();
+    stream_result.extra.push_back({ "bytes_per_upload", (double)(instances.size() * sizeof(GLfloat)) });
+    results.push_back(stream_result);
+}
+
+static void benchShaderCompile(std::vector<BenchResult> &results)
+{
+    BenchResult result = measure("shader_compile_link", 20, [&](uint64_t) {
+        ShaderHandler shader_handler;
+        loadGameShaders(shader_handler);
+        shader_handler.finishLinking();
+        glFinish();
+    });
+    results.push_back(result);
+
+    const char *cache_path = "benchmark_shaders.bin";
+    remove(cache_path);
+
+    {
+        // writes the cache that the measured runs load
+        ShaderHandler shader_handler;
+        loadGameShaders(shader_handler, cache_path);
+        shader_handler.finishLinking();
+    }
+
+    bool cached = false;
+    BenchResult cached_result = measure("shader_cache_load", 20, [&](uint64_t) {
+        ShaderHandler shader_handler;
+        loadGameShaders(shader_handler, cache_path);
+        shader_handler.finishLinking();
+        glFinish();
+        cached = shader_handler.isLoadedFromCache();
+    });
+    cached_result.extra.push_back({ "cache_hit", cached ? 1.0 : 0.0 });
+    results.push_back(cached_result);
+
+    remove(cache_path);
+}
+
+static void benchFullFrame(GameContext &ctx, int frames, std::vector<BenchResult> &results)
+{
+    constexpr double FRAME_DT = 1.0 / 60.0;
+
+    std::vector<double> frame_ms;
+    frame_ms.reserve(frames);
+
+    uint64_t rng = 42;
+
+    // a few warm-up frames so shader and buffer setup doesn't land in the stats
+    for (int i = -10; i < frames; i++) {
+        auto start = Clock::now();
+
+        GLState::beginFrame();
+        glfwPollEvents();
+
+        ctx.inputs = MatchControllers::trackBall(ctx.sim, rng);
+        updateGame(ctx, FRAME_DT);
+        renderGame(ctx);
+
+        glfwSwapBuffers(ctx.main_window);
+        glFinish();
+
+        if (i >= 0) frame_ms.push_back(elapsedNs(start) / 1e6);
+    }
+
+    std::vector<double> sorted = frame_ms;
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0.0;
+    for (double ms : frame_ms) total += ms;
+
+    BenchResult result;
+    result.name = "full_frame";
+    result.iterations = (uint64_t)frames;
+    result.ns_per_op = total * 1e6 / (double)frames;
+    result.extra.push_back({ "p50_ms", percentile(sorted, 0.50) });
+    result.extra.push_back({ "p95_ms", percentile(sorted, 0.95) });
+    result.extra.push_back({ "p99_ms", percentile(sorted, 0.99) });
+    result.extra.push_back({ "max_ms", sorted.back() });
+    results.push_back(result);
+}
+
+// Draw time for the spectator wall. Matches are stepped outside the timed
+// part; with one draw per frame, ns per match should fall as the wall grows.
+static void benchMatchWall(GameContext &ctx, std::vector<BenchResult> &results)
+{
+    constexpr int FRAMES = 200;
+    const float dt = 1.0f / GameConstants::SIM_TICK_RATE;
+
+    for (uint32_t num_matches : { 16u, 64u, 256u, 1024u }) {
+        MatchWall wall;
+        wall.init(num_matches, ctx.shader_handler);
+
+        double total_ns = 0.0;
+
+        for (int i = -10; i < FRAMES; i++) {
+            wall.step(dt);
+
+            auto start = Clock::now();
+
+            GLState::clearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            ctx.shader_handler.enableShaders();
+            wall.draw(ctx.renderer, ctx.shader_handler);
+            glFinish();
+
+            if (i >= 0) total_ns += elapsedNs(start);
+        }
+
+        BenchResult result;
+        result.name = "match_wall_" + std::to_string(num_matches);
+        result.iterations = FRAMES;
+        result.ns_per_op = total_ns / (double)FRAMES;
+        result.extra.push_back({ "ns_per_match", total_ns / (double)FRAMES / (double)num_matches });
+        result.extra.push_back({ "draw_calls", (double)ctx.renderer.getDrawCalls() });
+        results.push_back(result);
+
+        wall.destroy();
+    }
+}
+
+// A typical HUD: the score, three stats lines and eight profiler zones.
+// CPU time covers building and submitting the batch; gpu_ns_per_frame also
+// waits for the draw to finish. Returns false if a frame allocated, which
+// fails the run; the 0.1 ms budget is only reported, as it depends on the machine.
+static bool benchHudText(GameContext &ctx, std::vector<BenchResult> &results)
+{
+    constexpr int FRAMES = 2000;
+    constexpr double BUDGET_NS = 100000.0;
+
+    static const char *ZONES[] = { "framePacing", "glfwPollEvents", "physics", "drawGameObjects",
+                                   "glfwSwapBuffers", "inputLatency", "capture", "hud" };
+
+    auto buildHud = [&](int frame) {
+        ctx.text.begin(ctx.win_width, ctx.win_height);
+        ctx.text.print(440.0f, 16.0f, 6.0f, "%d   %d", frame % 10, (frame / 10) % 10);
+        ctx.text.print(8.0f, 8.0f, 2.0f, "%.0f fps  %.2f ms", 144.0, 6.94);
+        ctx.text.print(8.0f, 28.0f, 2.0f, "%u rects in %u draws", 23u, 1u);
+        ctx.text.print(8.0f, 48.0f, 2.0f, "gl calls %u issued %u skipped", 12u, 30u);
+        for (int z = 0; z < 8; z++) {
+            ctx.text.print(8.0f, 68.0f + 20.0f * (GLfloat)z, 2.0f, "%s %.3f ms", ZONES[z], 0.001 * (double)(frame % 1000));
+        }
+    };
+
+    // warm-up sizes every buffer before the counters start
+    for (int i = 0; i < 10; i++) {
+        buildHud(i);
+        ctx.text.draw();
+    }
+    glFinish();
+
+    uint64_t allocations_before = heap_allocations.load(std::memory_order_relaxed);
+
+    BenchResult result = measure("hud_text", FRAMES, [&](uint64_t i) {
+        buildHud((int)i);
+        ctx.text.draw();
+    });
+
+    uint64_t allocations = heap_allocations.load(std::memory_order_relaxed) - allocations_before;
+
+    BenchResult gpu_result = measure("hud_text_finished", 200, [&](uint64_t i) {
+        buildHud((int)i);
+        ctx.text.draw();
+        glFinish();
+    });
+
+    result.extra.push_back({ "glyphs", (double)ctx.text.getNumGlyphs() });
+    result.extra.push_back({ "draw_calls", (double)ctx.text.getDrawCalls() });
+    result.extra.push_back({ "allocations_per_frame", (double)allocations / (double)FRAMES });
+    result.extra.push_back({ "gpu_ns_per_frame", gpu_result.ns_per_op });
+    result.extra.push_back({ "budget_ns", BUDGET_NS });
+    result.extra.push_back({ "within_budget", result.ns_per_op <= BUDGET_NS ? 1.0 : 0.0 });
+    results.push_back(result);
+
+    if (allocations) {
+        printf("hud_text: %llu heap allocations over %d frames, expected none\n", (unsigned long long)allocations, FRAMES);
+        return false;
+    }
+
+    return true;
+}
+
+#endif
+
+static bool writeJson(const char *path, const std::vector<BenchResult> &results, const std::string &renderer)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        printf("Error opening '%s' for writing\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\n  \"renderer\": \"%s\",\n  \"batch_kernel\": \"%s\",\n  \"results\": [\n",
+            renderer.c_str(), BatchSimulator::getKernelName(BatchKernel::Auto));
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        fprintf(file, "    { \"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f",
+                r.name.c_str(), (unsigned long long)r.iterations, r.ns_per_op);
+        for (const auto &kv : r.extra) {
+            fprintf(file, ", \"%s\": %.6f", kv.first.c_str(), kv.second);
+        }
+        fprintf(file, " }%s\n", i + 1 < results.size() ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+static BenchOptions parseOptions(int argc, char **argv)
+{
+    BenchOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--out") && i + 1 < argc) options.out_path = argv[++i];
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc) options.frames = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--no-gl")) options.gl = false;
+        else if (!strcmp(argv[i], "--verify")) options.verify_only = true;
+    }
+
+    return options;
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options = parseOptions(argc, argv);
+    std::vector<BenchResult> results;
+
+    if (options.verify_only) {
+        uint64_t hits = 0;
+        uint64_t mismatches = verifyPaddleKernel(10000000, hits);
+        printf("paddle kernel vs legacy: %llu mismatches over 10000000 states (%llu hits)\n",
+               (unsigned long long)mismatches, (unsigned long long)hits);
+        return mismatches ? 1 : 0;
+    }
+
+    benchSimulationStep(results);
+    benchCollisions(results);
+    benchPaddleKernel(results);
+    benchBatchSimulator(results);
+    benchMatchRunner(results);
+    benchReplayPlayback(results);
+    benchRollback(results);
+    benchSpectatorStream(results);
+
+    std::string renderer = "none";
+    bool passed = true;
+
+#if !defined(SIMPLEPONG_HEADLESS)
+    benchStressWorld(results);
+
+    if (options.gl && glfwInit()) {
+        initWindowArgs();
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        GameContext ctx;
+        ctx.main_window = glfwCreateWindow(ctx.win_width, ctx.win_height, "Simple Pong benchmark", nullptr, nullptr);
+
+        if (ctx.main_window) {
+            initMainWindow(ctx.main_window, ctx);
+            initGame(ctx);
+            glfwSwapInterval(0);
+
+            renderer = (const char *)glGetString(GL_RENDERER);
+
+            benchBufferUploads(results);
+            benchShaderCompile(results);
+            benchFullFrame(ctx, options.frames, results);
+            benchMatchWall(ctx, results);
+            passed = benchHudText(ctx, results);
+
+            glfwDestroyWindow(ctx.main_window);
+        } else {
+            printf("No GL context available, skipping GL benchmarks\n");
+        }
+
+        glfwTerminate();
+    }
+#endif
+
+    printf("renderer: %s\n", renderer.c_str());
+    for (const BenchResult &result : results) {
+        printResult(result);
+    }
+
+    return writeJson(options.out_path, results, renderer) && passed ? 0 : 1;
+}
\ No newline at end of file
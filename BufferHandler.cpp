@@ -1,4 +1,153 @@
 #include "BufferHandler.hpp"
+#include "GLState.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+	constexpr GLsizeiptr INSTANCE_SEGMENT_SIZE = 64 * 1024;
+	constexpr GLsizeiptr STREAM_ALIGNMENT = 256;
+}
+
+StreamingBuffer::StreamingBuffer()
+{
+
+}
+
+void StreamingBuffer::create(GLenum buffer_target, GLsizeiptr size)
+{
+	target = buffer_target;
+	use_storage = GLEW_ARB_buffer_storage;
+	glGenBuffers(1, &id_buffer);
+	allocate(size);
+}
+
+void StreamingBuffer::destroy()
+{
+	for (GLsync& fence : fences) {
+		if (fence) glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	if (id_buffer) {
+		GLState::bindBuffer(target, id_buffer);
+		if (persistent_ptr) glUnmapBuffer(target);
+		GLState::bindBuffer(target, 0);
+		glDeleteBuffers(1, &id_buffer);
+		GLState::invalidate();
+	}
+
+	id_buffer = 0;
+	persistent_ptr = nullptr;
+}
+
+void StreamingBuffer::allocate(GLsizeiptr new_segment_size)
+{
+	segment_size = (new_segment_size + STREAM_ALIGNMENT - 1) & ~(STREAM_ALIGNMENT - 1);
+	segment = 0;
+	cursor = 0;
+
+	for (GLsync& fence : fences) {
+		if (fence) glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	if (use_storage) {
+		// immutable storage can't be resized, so growing needs a fresh buffer name
+		if (persistent_ptr) {
+			GLState::bindBuffer(target, id_buffer);
+			glUnmapBuffer(target);
+			glDeleteBuffers(1, &id_buffer);
+			GLState::invalidate();
+			glGenBuffers(1, &id_buffer);
+		}
+
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		GLState::bindBuffer(target, id_buffer);
+		glBufferStorage(target, segment_size * NUM_SEGMENTS, nullptr, flags);
+		persistent_ptr = (unsigned char*)glMapBufferRange(target, 0, segment_size * NUM_SEGMENTS, flags);
+		return;
+	}
+
+	GLState::bindBuffer(target, id_buffer);
+	glBufferData(target, segment_size * NUM_SEGMENTS, nullptr, GL_STREAM_DRAW);
+}
+
+void StreamingBuffer::acquireSegment()
+{
+	GLsync& fence = fences[segment];
+	if (!fence) return;
+
+	GLenum status = glClientWaitSync(fence, 0, 0);
+
+	if (status == GL_TIMEOUT_EXPIRED) {
+		if (persistent_ptr) {
+			// persistent storage can't be orphaned, the GPU is 3 frames behind so wait
+			glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+			frame_stats.waits++;
+		} else {
+			GLState::bindBuffer(target, id_buffer);
+			glBufferData(target, segment_size * NUM_SEGMENTS, nullptr, GL_STREAM_DRAW);
+			frame_stats.orphans++;
+
+			// fresh storage, nothing on it is pending any more
+			for (GLsync& f : fences) {
+				if (f) glDeleteSync(f);
+				f = nullptr;
+			}
+			return;
+		}
+	}
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void* StreamingBuffer::map(GLsizeiptr size, GLintptr& offset)
+{
+	GLsizeiptr aligned = (size + STREAM_ALIGNMENT - 1) & ~(STREAM_ALIGNMENT - 1);
+
+	if (cursor + aligned > segment_size) {
+		// the frame outgrew its segment, draws already issued keep the old storage alive
+		allocate((cursor + aligned) * 2);
+	}
+
+	if (cursor == 0) acquireSegment();
+
+	offset = segment * segment_size + cursor;
+	cursor += aligned;
+	frame_stats.upload_bytes += size;
+
+	if (persistent_ptr) {
+		return persistent_ptr + offset;
+	}
+
+	GLState::bindBuffer(target, id_buffer);
+	mapped = true;
+	return glMapBufferRange(target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void StreamingBuffer::unmap()
+{
+	if (!mapped) return;
+
+	GLState::bindBuffer(target, id_buffer);
+	glUnmapBuffer(target);
+	mapped = false;
+}
+
+void StreamingBuffer::endFrame()
+{
+	if (cursor > 0) {
+		fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		segment = (segment + 1) % NUM_SEGMENTS;
+		cursor = 0;
+	}
+
+	last_frame_stats = frame_stats;
+	frame_stats = StreamingStats();
+}
 
 BufferHandler::BufferHandler()
 {
@@ -10,66 +159,103 @@ void BufferHandler::generateBuffers()
 	glGenVertexArrays(1, &id_vao);
 	glGenBuffers(1, &id_ibo);
 	glGenBuffers(1, &id_vbo);
+	instance_stream.create(GL_ARRAY_BUFFER, INSTANCE_SEGMENT_SIZE);
 }
 
-void BufferHandler::addIndexData(GLuint *indices_arr, GLuint size)
+void BufferHandler::addIndexData(const GLuint *indices_arr, GLuint size)
 {
-	for (size_t i = 0; i < size; i++) {
-		indices.push_back(indices_arr[i]);
-	}
-	index_sizes.push_back(size);
+	indices.insert(indices.end(), indices_arr, indices_arr + size);
 }
 
-void BufferHandler::addVertexData(GLfloat *vertices_arr, GLuint size)
+void BufferHandler::addVertexData(const GLfloat *vertices_arr, GLuint size)
 {
-	for (size_t i = 0; i < size; i++) {
-		vertices.push_back(vertices_arr[i]);
+	vertices.insert(vertices.end(), vertices_arr, vertices_arr + size);
+}
+
+void BufferHandler::addMesh(const GLfloat *vertices_arr, GLuint num_vertex_floats, const GLuint *indices_arr, GLuint num_indices)
+{
+	GLuint base_vertex = getNumVertices();
+
+	vertices.insert(vertices.end(), vertices_arr, vertices_arr + num_vertex_floats);
+
+	size_t first = indices.size();
+	indices.resize(first + num_indices);
+
+	for (GLuint i = 0; i < num_indices; i++) {
+		indices[first + i] = indices_arr[i] + base_vertex;
 	}
-	vertex_sizes.push_back(size);
+}
+
+void BufferHandler::reserve(size_t num_vertex_floats, size_t num_indices)
+{
+	// grow geometrically: reserving exactly what each call adds would
+	// reallocate on every call and make repeated adds quadratic
+	size_t vertex_floats = vertices.size() + num_vertex_floats;
+	if (vertex_floats > vertices.capacity()) vertices.reserve(std::max(vertex_floats, 2 * vertices.capacity()));
+
+	size_t total_indices = indices.size() + num_indices;
+	if (total_indices > indices.capacity()) indices.reserve(std::max(total_indices, 2 * indices.capacity()));
+}
+
+void BufferHandler::clear()
+{
+	// keeps capacity, so rebuilding a same-sized level doesn't reallocate
+	vertices.clear();
+	indices.clear();
 }
 
 void BufferHandler::bindIndexBuffer()
 {
-	glBindVertexArray(id_vao);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_ibo);
+	GLState::bindVertexArray(id_vao);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_ibo);
 }
 
 void BufferHandler::unbindIndexBuffer()
 {
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	// the element buffer stays attached to the VAO, only the VAO is unbound
+	GLState::bindVertexArray(0);
 }
 
 void BufferHandler::loadDataToGPU() 
 {
-	glBindVertexArray(id_vao);
+	GLState::bindVertexArray(id_vao);
 
-	glBindBuffer(GL_ARRAY_BUFFER, id_vbo);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), 0, GL_STATIC_DRAW);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, id_vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
 
-	size_t offset = 0;
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), 0);
 
-	for (size_t i = 0; i < vertex_sizes.size(); i++) {
-		glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(GLfloat), vertex_sizes[i] * sizeof(GLfloat), &vertices[offset]);
-		offset += vertex_sizes[i];
-	}
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
 
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), 0);
+	glEnableVertexAttribArray(0);
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), 0, GL_STATIC_DRAW);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, instance_stream.getId());
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(1);
 
-	offset = 0;
+	GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
 
-	for (size_t i = 0; i < index_sizes.size(); i++) {
-		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset * sizeof(GLuint), index_sizes[i] * sizeof(GLuint), &indices[offset]);
-		offset += index_sizes[i];
-	}
+	GLState::bindVertexArray(0);
+}
 
-	glEnableVertexAttribArray(0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+void BufferHandler::loadInstanceData(const GLfloat *instance_arr, GLuint num_floats)
+{
+	GLintptr offset = 0;
+	GLsizeiptr size = num_floats * sizeof(GLfloat);
+
+	void* dst = instance_stream.map(size, offset);
+	memcpy(dst, instance_arr, size);
+	instance_stream.unmap();
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	// the ring moves every frame, so point attribute 1 at this frame's slice
+	GLState::bindVertexArray(id_vao);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, instance_stream.getId());
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)offset);
+}
 
-	glBindVertexArray(0);
+void BufferHandler::endFrame()
+{
+	instance_stream.endFrame();
 }
\ No newline at end of file
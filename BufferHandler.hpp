@@ -4,26 +4,114 @@
 #include <vector>
 #include <GL/glew.h>
 
+struct StreamingStats
+{
+    GLsizeiptr upload_bytes = 0;
+    unsigned waits = 0;
+    unsigned orphans = 0;
+};
+
+// Triple-buffered ring for data rewritten every frame. Uses one persistently
+// mapped buffer when ARB_buffer_storage is available, otherwise maps each
+// range unsynchronized. A fence guards every segment; when the GPU still owns
+// the next one, the fallback orphans the buffer instead of waiting.
+class StreamingBuffer
+{
+public:
+    static constexpr int NUM_SEGMENTS = 3;
+
+    StreamingBuffer();
+    void create(GLenum target, GLsizeiptr segment_size);
+    void destroy();
+
+    // Reserves size bytes in the current frame's segment. offset receives the
+    // byte offset of the reservation, to be used in attribute pointers or binds.
+    void* map(GLsizeiptr size, GLintptr &offset);
+    void unmap();
+
+    // Fences the segment used by this frame's draws and moves to the next one.
+    void endFrame();
+
+    GLuint getId() const { return id_buffer; }
+    bool isPersistent() const { return persistent_ptr != nullptr; }
+    const StreamingStats& getFrameStats() const { return frame_stats; }
+    const StreamingStats& getLastFrameStats() const { return last_frame_stats; }
+
+private:
+    void allocate(GLsizeiptr new_segment_size);
+    void acquireSegment();
+
+    GLenum target = GL_ARRAY_BUFFER;
+    GLuint id_buffer{};
+    GLsizeiptr segment_size = 0;
+    GLsizeiptr cursor = 0;
+    int segment = 0;
+    bool use_storage = false;
+    bool mapped = false;
+
+    GLsync fences[NUM_SEGMENTS]{};
+    unsigned char* persistent_ptr = nullptr;
+
+    StreamingStats frame_stats;
+    StreamingStats last_frame_stats;
+};
+
 class BufferHandler
 {
 public:
     BufferHandler();
     void generateBuffers();
     void loadDataToGPU();
-    void addIndexData(GLuint* indices_arr, GLuint size);
-    void addVertexData(GLfloat* vertices_arr, GLuint size);
+    void addIndexData(const GLuint* indices_arr, GLuint size);
+    void addVertexData(const GLfloat* vertices_arr, GLuint size);
+
+    // Appends a mesh and rebases its indices onto the vertices already added.
+    void addMesh(const GLfloat* vertices_arr, GLuint num_vertex_floats, const GLuint* indices_arr, GLuint num_indices);
+
+    // Appends every shape in a range (anything with vertices/indices and their
+    // counts, e.g. std::vector<Rectangle2D>) after a single up-front reserve.
+    template <class Range>
+    void addShapes(const Range& shapes);
+
+    void reserve(size_t num_vertex_floats, size_t num_indices);
+    void clear();
+    GLuint getNumVertices() const { return (GLuint)(vertices.size() / 2); }
+    GLuint getNumIndices() const { return (GLuint)indices.size(); }
+
     void bindIndexBuffer();
     void unbindIndexBuffer();
+
+    // Per-instance data for attribute 1 (vec4, advanced once per instance),
+    // streamed through a ring buffer. Call endFrame() after the frame's draws.
+    void loadInstanceData(const GLfloat* instance_arr, GLuint num_floats);
+    void endFrame();
+    const StreamingStats& getLastFrameStreamingStats() const { return instance_stream.getLastFrameStats(); }
 private:
     std::vector<GLfloat> vertices;
-    std::vector<GLuint> vertex_sizes;
-
     std::vector<GLuint> indices;
-    std::vector<GLuint> index_sizes;
 
     GLuint id_ibo{};
     GLuint id_vbo{};
     GLuint id_vao{};
+    StreamingBuffer instance_stream;
 };
 
+template <class Range>
+void BufferHandler::addShapes(const Range& shapes)
+{
+    size_t num_vertex_floats = 0;
+    size_t num_indices = 0;
+
+    for (const auto& shape : shapes) {
+        num_vertex_floats += shape.getNumVertices();
+        num_indices += shape.getNumIndices();
+    }
+
+    reserve(num_vertex_floats, num_indices);
+
+    for (const auto& shape : shapes) {
+        addMesh(shape.vertices, shape.getNumVertices(), shape.indices, shape.getNumIndices());
+    }
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "FixedTimestep.hpp"
+
+FixedTimestep::FixedTimestep(int tick_rate, int max_substeps) : max_substeps(max_substeps)
+{
+    setTickRate(tick_rate);
+}
+
+void FixedTimestep::setTickRate(int rate)
+{
+    tick_rate = rate > 0 ? rate : GameConstants::SIM_TICK_RATE;
+    tick_dt = 1.0f / (float)tick_rate;
+    accumulator = 0.0;
+}
+
+void FixedTimestep::reset()
+{
+    accumulator = 0.0;
+}
+
+int FixedTimestep::advance(double frame_dt)
+{
+    if (frame_dt > 0.0) accumulator += frame_dt;
+
+    int ticks = (int)(accumulator / tick_dt);
+
+    // After a long hitch, drop the backlog instead of trying to catch up forever.
+    if (ticks > max_substeps) {
+        ticks = max_substeps;
+        accumulator = 0.0;
+        return ticks;
+    }
+
+    accumulator -= ticks * (double)tick_dt;
+    return ticks;
+}
+
+float FixedTimestep::getAlpha() const
+{
+    return (float)(accumulator / tick_dt);
+}
+
+SimVec2 Simulation::interpolate(const SimBody &prev, const SimBody &curr, float alpha)
+{
+    return {
+        prev.position.x + (curr.position.x - prev.position.x) * alpha,
+        prev.position.y + (curr.position.y - prev.position.y) * alpha
+    };
+}
\ No newline at end of file
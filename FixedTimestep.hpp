@@ -0,0 +1,37 @@
+#ifndef FIXED_TIMESTEP_HPP
+#define FIXED_TIMESTEP_HPP
+
+#include "Simulation.hpp"
+
+// Accumulates real frame time and hands it out as whole simulation ticks,
+// so the physics always advances with the same dt regardless of frame rate.
+class FixedTimestep
+{
+public:
+    FixedTimestep(int tick_rate = GameConstants::SIM_TICK_RATE, int max_substeps = GameConstants::SIM_MAX_SUBSTEPS);
+
+    void setTickRate(int tick_rate);
+    void reset();
+
+    // Adds frame_dt seconds and returns the number of ticks to simulate this frame.
+    int advance(double frame_dt);
+
+    float getTickDt() const { return tick_dt; }
+    int getTickRate() const { return tick_rate; }
+
+    // Fraction of a tick left in the accumulator, used to blend the last two states when drawing.
+    float getAlpha() const;
+
+private:
+    int tick_rate = 0;
+    int max_substeps = 0;
+    float tick_dt = 0.0f;
+    double accumulator = 0.0;
+};
+
+namespace Simulation {
+
+    SimVec2 interpolate(const SimBody &prev, const SimBody &curr, float alpha);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "FrameCapture.hpp"
+#include <cctype>
+#include <cstring>
+#include "GLState.hpp"
+
+namespace {
+
+    // Splits "dir/frame_%05d.ppm" around its one integer conversion. "%%" is a
+    // literal '%'. Anything else after a '%', or a second conversion, fails.
+    bool splitSequencePath(const std::string &path, std::string &prefix, std::string &spec, std::string &suffix)
+    {
+        prefix.clear();
+        spec.clear();
+        suffix.clear();
+
+        for (size_t i = 0; i < path.size(); i++) {
+            std::string &part = spec.empty() ? prefix : suffix;
+
+            if (path[i] != '%') {
+                part += path[i];
+                continue;
+            }
+
+            if (i + 1 < path.size() && path[i + 1] == '%') {
+                part += '%';
+                i++;
+                continue;
+            }
+
+            if (!spec.empty()) return false;
+
+            size_t j = i + 1;
+            while (j < path.size() && strchr("0-+ #", path[j])) j++;
+            while (j < path.size() && isdigit((unsigned char)path[j])) j++;
+            if (j >= path.size() || !strchr("diu", path[j])) return false;
+
+            spec = path.substr(i, j - i) + "d";
+            i = j;
+        }
+
+        return !spec.empty();
+    }
+}
+
+bool OffscreenTarget::create(GLsizei w, GLsizei h)
+{
+    width = w;
+    height = h;
+
+    glGenRenderbuffers(1, &id_color);
+    glBindRenderbuffer(GL_RENDERBUFFER, id_color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &id_framebuffer);
+    GLState::bindFramebuffer(id_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, id_color);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    GLState::bindFramebuffer(0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        printf("Error creating offscreen framebuffer: status 0x%x\n", status);
+        destroy();
+        return false;
+    }
+
+    return true;
+}
+
+void OffscreenTarget::destroy()
+{
+    if (id_framebuffer) {
+        GLState::bindFramebuffer(0);
+        glDeleteFramebuffers(1, &id_framebuffer);
+    }
+    if (id_color) glDeleteRenderbuffers(1, &id_color);
+
+    id_framebuffer = 0;
+    id_color = 0;
+}
+
+void OffscreenTarget::bind()
+{
+    GLState::bindFramebuffer(id_framebuffer);
+    GLState::viewport(0, 0, width, height);
+}
+
+void OffscreenTarget::unbind()
+{
+    GLState::bindFramebuffer(0);
+}
+
+FrameSink::~FrameSink()
+{
+    close();
+}
+
+bool FrameSink::open(const std::string &p)
+{
+    close();
+
+    path = p;
+    frames_written = 0;
+    format = path.find('%') != std::string::npos ? Format::Ppm : Format::Raw;
+
+    if (format == Format::Ppm && !splitSequencePath(path, path_prefix, frame_spec, path_suffix)) {
+        printf("Error: capture path '%s' needs exactly one integer conversion, e.g. frame_%%05d.ppm\n", path.c_str());
+        return false;
+    }
+
+    if (format == Format::Raw) {
+        raw_file = fopen(path.c_str(), "wb");
+        if (!raw_file) {
+            printf("Error opening '%s' for writing\n", path.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FrameSink::close()
+{
+    if (raw_file) fclose(raw_file);
+    raw_file = nullptr;
+}
+
+bool FrameSink::writeFrame(const unsigned char *rgba, GLsizei width, GLsizei height)
+{
+    size_t row_bytes = (size_t)width * 4;
+
+    if (format == Format::Raw) {
+        if (!raw_file) return false;
+
+        bool ok = fwrite(rgba, row_bytes, (size_t)height, raw_file) == (size_t)height;
+        if (ok) frames_written++;
+        return ok;
+    }
+
+    // only the validated conversion is ever used as a format string
+    char number[32];
+    snprintf(number, sizeof(number), frame_spec.c_str(), (int)frames_written);
+
+    char file_name[1024];
+    snprintf(file_name, sizeof(file_name), "%s%s%s", path_prefix.c_str(), number, path_suffix.c_str());
+
+    FILE *file = fopen(file_name, "wb");
+    if (!file) {
+        printf("Error opening '%s' for writing\n", file_name);
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+
+    // PPM is top-down RGB
+    row.resize((size_t)width * 3);
+    bool ok = true;
+
+    for (GLsizei y = height - 1; y >= 0 && ok; y--) {
+        const unsigned char *src = rgba + (size_t)y * row_bytes;
+        for (GLsizei x = 0; x < width; x++) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        ok = fwrite(row.data(), 1, row.size(), file) == row.size();
+    }
+
+    fclose(file);
+
+    if (ok) frames_written++;
+    return ok;
+}
+
+bool FrameCapture::create(GLsizei w, GLsizei h, FrameSink *frame_sink)
+{
+    width = w;
+    height = h;
+    sink = frame_sink;
+    next = 0;
+    stats = CaptureStats();
+
+    glGenBuffers(NUM_PBOS, pbos);
+    for (GLuint pbo : pbos) {
+        GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, nullptr, GL_STREAM_READ);
+    }
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    return true;
+}
+
+void FrameCapture::destroy()
+{
+    for (GLsync &fence : fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDeleteBuffers(NUM_PBOS, pbos);
+    for (GLuint &pbo : pbos) pbo = 0;
+}
+
+void FrameCapture::capture()
+{
+    int index = next;
+    next = (next + 1) % NUM_PBOS;
+
+    // the slot is about to be reused, so collect whatever it still holds first
+    if (fences[index]) readBack(index);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[index]);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    fences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    // the other slot was filled last frame and is most likely done by now
+    if (fences[next]) readBack(next);
+}
+
+void FrameCapture::finish()
+{
+    // oldest first
+    for (int i = 0; i < NUM_PBOS; i++) {
+        int index = (next + i) % NUM_PBOS;
+        if (fences[index]) readBack(index);
+    }
+}
+
+void FrameCapture::readBack(int index)
+{
+    GLenum result = glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        stats.stalls++;
+        glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    }
+
+    glDeleteSync(fences[index]);
+    fences[index] = nullptr;
+
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[index]);
+
+    const unsigned char *pixels = (const unsigned char *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)width * height * 4, GL_MAP_READ_BIT);
+    if (pixels) {
+        if (sink) sink->writeFrame(pixels, width, height);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        stats.frames++;
+    }
+
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
\ No newline at end of file
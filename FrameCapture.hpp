@@ -0,0 +1,112 @@
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+// Framebuffer object with a single RGBA8 color attachment, for rendering
+// without a visible window.
+class OffscreenTarget
+{
+public:
+    bool create(GLsizei width, GLsizei height);
+    void destroy();
+
+    // Binds the target and sets the viewport to cover it.
+    void bind();
+    void unbind();
+
+    GLuint getId() const { return id_framebuffer; }
+    GLsizei getWidth() const { return width; }
+    GLsizei getHeight() const { return height; }
+
+private:
+    GLuint id_framebuffer{};
+    GLuint id_color{};
+    GLsizei width = 0;
+    GLsizei height = 0;
+};
+
+// Where captured frames go. Raw appends tightly packed RGBA8 frames to one
+// file, ready for e.g.
+//     ffmpeg -f rawvideo -pix_fmt rgba -s 1000x800 -r 60 -i out.rgba -vf vflip out.mp4
+// Ppm writes one image per frame; the path is a printf pattern like "frame_%05d.ppm".
+class FrameSink
+{
+public:
+    enum class Format
+    {
+        Raw,
+        Ppm
+    };
+
+    ~FrameSink();
+
+    // Paths containing a '%' are treated as PPM sequences and must hold exactly
+    // one integer conversion such as %05d ("%%" is a literal '%'); anything
+    // else is raw video.
+    bool open(const std::string &path);
+    void close();
+
+    // rgba is bottom-up, as glReadPixels returns it.
+    bool writeFrame(const unsigned char *rgba, GLsizei width, GLsizei height);
+
+    Format getFormat() const { return format; }
+    uint64_t getFramesWritten() const { return frames_written; }
+
+private:
+    Format format = Format::Raw;
+    std::string path;
+    std::string path_prefix;
+    std::string frame_spec;
+    std::string path_suffix;
+    FILE *raw_file = nullptr;
+    std::vector<unsigned char> row;
+    uint64_t frames_written = 0;
+};
+
+struct CaptureStats
+{
+    uint64_t frames = 0;
+
+    // readbacks whose fence wasn't signalled yet when the data was needed
+    uint64_t stalls = 0;
+};
+
+// Reads the bound framebuffer back through two pixel pack buffers. Each frame
+// starts an asynchronous glReadPixels into one PBO and maps the other, which
+// was filled a frame earlier, so the CPU never waits on the frame just drawn.
+class FrameCapture
+{
+public:
+    static constexpr int NUM_PBOS = 2;
+
+    bool create(GLsizei width, GLsizei height, FrameSink *sink);
+    void destroy();
+
+    // Call after rendering, with the captured framebuffer bound.
+    void capture();
+
+    // Hands any frames still in flight to the sink.
+    void finish();
+
+    const CaptureStats& getStats() const { return stats; }
+
+private:
+    void readBack(int index);
+
+    GLuint pbos[NUM_PBOS]{};
+    GLsync fences[NUM_PBOS]{};
+    int next = 0;
+
+    GLsizei width = 0;
+    GLsizei height = 0;
+    FrameSink *sink = nullptr;
+
+    CaptureStats stats;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "FramePacer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include "InputQueue.hpp"
+
+namespace {
+
+    constexpr int64_t MIN_SPIN_MARGIN_NS = 250000;
+    constexpr int64_t MAX_SPIN_MARGIN_NS = 4000000;
+
+    // frames in a row under half a refresh before vsync counts as ignored
+    constexpr uint32_t VSYNC_CHECK_FRAMES = 120;
+}
+
+void FramePacer::init(VsyncMode vsync, double target_rate)
+{
+    const GLFWvidmode *mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    if (mode && mode->refreshRate > 0) refresh_rate = mode->refreshRate;
+
+    setVsync(vsync);
+    setTargetRate(target_rate);
+    resetStats();
+}
+
+void FramePacer::setVsync(VsyncMode mode)
+{
+    vsync = mode;
+    fast_frames = 0;
+
+    int interval = 0;
+
+    if (mode == VsyncMode::On) {
+        interval = 1;
+    } else if (mode == VsyncMode::Adaptive) {
+        bool tear = glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+        if (!tear) printf("Adaptive vsync not supported, using vsync\n");
+        interval = tear ? -1 : 1;
+    }
+
+    glfwSwapInterval(interval);
+}
+
+void FramePacer::setTargetRate(double rate)
+{
+    target_rate = std::max(rate, 0.0);
+    next_deadline_ns = 0;
+}
+
+void FramePacer::wait(bool idle)
+{
+    double rate = idle ? (target_rate > 0.0 ? std::min(target_rate, IDLE_RATE) : IDLE_RATE) : target_rate;
+
+    // leaving idle must not inherit a deadline from the slow schedule
+    if (idle != was_idle) next_deadline_ns = 0;
+    was_idle = idle;
+
+    uint64_t now_ns = InputQueue::nowNs();
+
+    if (rate <= 0.0) {
+        next_deadline_ns = 0;
+        recordFrame(now_ns, idle);
+        return;
+    }
+
+    uint64_t period_ns = (uint64_t)(1e9 / rate);
+
+    // a frame that ran over by more than a period starts a new schedule
+    // instead of rushing the next few frames to catch up
+    if (next_deadline_ns == 0 || now_ns > next_deadline_ns + period_ns) {
+        if (next_deadline_ns != 0) stats.missed_deadlines++;
+        next_deadline_ns = now_ns;
+    }
+
+    if (idle) {
+        // returns at the deadline or on the first input event
+        if (next_deadline_ns > now_ns) {
+            glfwWaitEventsTimeout((double)(next_deadline_ns - now_ns) / 1e9);
+        }
+
+        uint64_t woke_ns = InputQueue::nowNs();
+        stats.sleep_ms += (double)(woke_ns - now_ns) / 1e6;
+        next_deadline_ns = woke_ns + period_ns;
+        recordFrame(woke_ns, idle);
+        return;
+    }
+
+    sleepUntil(next_deadline_ns);
+    next_deadline_ns += period_ns;
+    recordFrame(InputQueue::nowNs(), idle);
+}
+
+void FramePacer::sleepUntil(uint64_t deadline_ns)
+{
+    uint64_t start_ns = InputQueue::nowNs();
+    if (start_ns >= deadline_ns) return;
+
+    uint64_t spin_start_ns = start_ns;
+    int64_t sleep_ns = (int64_t)(deadline_ns - start_ns) - spin_margin_ns;
+
+    if (sleep_ns > 0) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(sleep_ns));
+        spin_start_ns = InputQueue::nowNs();
+
+        // keep the margin a bit above the worst recent oversleep, decaying
+        // slowly so one scheduler hiccup doesn't cost spinning forever
+        int64_t oversleep_ns = (int64_t)(spin_start_ns - start_ns) - sleep_ns;
+        spin_margin_ns = std::max(spin_margin_ns - spin_margin_ns / 64, oversleep_ns + oversleep_ns / 4);
+        spin_margin_ns = std::min(std::max(spin_margin_ns, MIN_SPIN_MARGIN_NS), MAX_SPIN_MARGIN_NS);
+
+        stats.sleep_ms += (double)(spin_start_ns - start_ns) / 1e6;
+    }
+
+    uint64_t now_ns = spin_start_ns;
+    while (now_ns < deadline_ns) {
+        std::this_thread::yield();
+        now_ns = InputQueue::nowNs();
+    }
+
+    stats.spin_ms += (double)(now_ns - spin_start_ns) / 1e6;
+}
+
+void FramePacer::recordFrame(uint64_t now_ns, bool idle)
+{
+    uint64_t last_ns = last_frame_ns;
+    last_frame_ns = now_ns;
+
+    // idle frames are slow on purpose; keep them, and the first frame after
+    // them, out of the interval stats
+    if (idle) {
+        stats.idle_frames++;
+        last_frame_ns = 0;
+        return;
+    }
+
+    if (last_ns == 0) return;
+
+    double interval_ms = (double)(now_ns - last_ns) / 1e6;
+
+    // Welford's running mean and variance
+    stats.frames++;
+    double delta = interval_ms - stats.mean_interval_ms;
+    stats.mean_interval_ms += delta / (double)stats.frames;
+    stats.interval_m2 += delta * (interval_ms - stats.mean_interval_ms);
+    stats.jitter_ms = std::sqrt(stats.interval_m2 / (double)stats.frames);
+    stats.max_interval_ms = std::max(stats.max_interval_ms, interval_ms);
+
+    checkVsyncWorks(interval_ms);
+}
+
+void FramePacer::checkVsyncWorks(double interval_ms)
+{
+    if (vsync == VsyncMode::Off || target_rate > 0.0) return;
+
+    // some drivers ignore the swap interval; cap at the refresh rate then
+    // rather than render thousands of identical frames
+    fast_frames = interval_ms < 500.0 / refresh_rate ? fast_frames + 1 : 0;
+
+    if (fast_frames >= VSYNC_CHECK_FRAMES) {
+        printf("Vsync looks disabled by the driver, capping at %.0f fps\n", refresh_rate);
+        setTargetRate(refresh_rate);
+    }
+}
+
+void FramePacer::resetStats()
+{
+    stats = FramePacingStats();
+    last_frame_ns = 0;
+}
+
+const char* FramePacer::getVsyncName(VsyncMode mode)
+{
+    switch (mode) {
+    case VsyncMode::Off: return "off";
+    case VsyncMode::On: return "on";
+    case VsyncMode::Adaptive: return "adaptive";
+    }
+    return "unknown";
+}
\ No newline at end of file
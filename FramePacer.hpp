@@ -0,0 +1,86 @@
+#ifndef FRAME_PACER_HPP
+#define FRAME_PACER_HPP
+
+#include <cstdint>
+#include <GLFW/glfw3.h>
+
+enum class VsyncMode
+{
+    Off,
+    On,
+    // swaps late frames right away instead of waiting a whole refresh,
+    // where the driver supports it; plain vsync otherwise
+    Adaptive
+};
+
+// Intervals cover non-idle frames only; jitter is their standard deviation.
+struct FramePacingStats
+{
+    uint64_t frames = 0;
+    uint64_t idle_frames = 0;
+    uint64_t missed_deadlines = 0;
+
+    double mean_interval_ms = 0.0;
+    double jitter_ms = 0.0;
+    double max_interval_ms = 0.0;
+
+    // time spent waiting for the next frame, asleep and busy
+    double sleep_ms = 0.0;
+    double spin_ms = 0.0;
+
+    // running sum of squared deviations, for jitter
+    double interval_m2 = 0.0;
+};
+
+// Decides when the next frame starts. With a target rate, each frame has a
+// deadline one period after the last; the pacer sleeps most of the way there
+// and spins the last stretch, sized from how late recent sleeps woke up, so
+// deadlines are hit to within microseconds without burning a core. Waiting
+// happens before input is polled, so pacing never makes input older.
+// While idle the rate drops, and any input event ends the wait early.
+class FramePacer
+{
+public:
+    static constexpr double IDLE_RATE = 20.0;
+
+    // Sets the swap interval on the current context.
+    void init(VsyncMode vsync, double target_rate);
+
+    void setVsync(VsyncMode mode);
+    VsyncMode getVsync() const { return vsync; }
+
+    // Frames per second to cap at; 0 leaves the pace to vsync, or uncapped.
+    void setTargetRate(double rate);
+    double getTargetRate() const { return target_rate; }
+
+    // Blocks until the next frame should start.
+    void wait(bool idle);
+
+    const FramePacingStats& getStats() const { return stats; }
+    void resetStats();
+
+    static const char* getVsyncName(VsyncMode mode);
+
+private:
+    void sleepUntil(uint64_t deadline_ns);
+    void recordFrame(uint64_t now_ns, bool idle);
+    void checkVsyncWorks(double interval_ms);
+
+    VsyncMode vsync = VsyncMode::On;
+    double target_rate = 0.0;
+    double refresh_rate = 60.0;
+
+    uint64_t next_deadline_ns = 0;
+    uint64_t last_frame_ns = 0;
+    bool was_idle = false;
+
+    // how long before a deadline to stop sleeping and start spinning
+    int64_t spin_margin_ns = 2000000;
+
+    // frames since vsync was turned on that came in well under a refresh
+    uint32_t fast_frames = 0;
+
+    FramePacingStats stats;
+};
+
+#endif
\ No newline at end of file
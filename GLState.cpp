@@ -0,0 +1,218 @@
+#include "GLState.hpp"
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+    constexpr GLuint UNKNOWN = 0xFFFFFFFFu;
+
+    enum BufferSlot
+    {
+        SLOT_ARRAY,
+        SLOT_UNIFORM,
+        SLOT_PIXEL_PACK,
+        SLOT_PIXEL_UNPACK,
+        SLOT_DRAW_INDIRECT,
+        SLOT_TEXTURE,
+        NUM_SLOTS
+    };
+
+    enum TextureSlot
+    {
+        TEXTURE_SLOT_2D,
+        TEXTURE_SLOT_BUFFER,
+        NUM_TEXTURE_SLOTS
+    };
+
+    constexpr GLuint NUM_TEXTURE_UNITS = 8;
+
+    struct TrackedState
+    {
+        GLuint program = UNKNOWN;
+        GLuint vao = UNKNOWN;
+        GLuint framebuffer = UNKNOWN;
+        GLuint buffers[NUM_SLOTS];
+        GLuint active_texture_unit = UNKNOWN;
+        GLuint textures[NUM_TEXTURE_UNITS][NUM_TEXTURE_SLOTS];
+        GLfloat clear_color[4];
+        GLint viewport[4];
+        bool clear_color_known = false;
+        bool viewport_known = false;
+
+        // element array bindings are part of the VAO, so remember them per VAO
+        std::unordered_map<GLuint, GLuint> vao_element_buffer;
+
+        GLStateStats frame;
+        GLStateStats last_frame;
+
+        TrackedState() { reset(); }
+
+        void reset()
+        {
+            program = UNKNOWN;
+            vao = UNKNOWN;
+            framebuffer = UNKNOWN;
+            for (GLuint &b : buffers) b = UNKNOWN;
+            active_texture_unit = UNKNOWN;
+            for (auto &unit : textures) {
+                for (GLuint &t : unit) t = UNKNOWN;
+            }
+            clear_color_known = false;
+            viewport_known = false;
+            vao_element_buffer.clear();
+        }
+    };
+
+    TrackedState state;
+
+    int slotOf(GLenum target)
+    {
+        switch (target) {
+        case GL_ARRAY_BUFFER: return SLOT_ARRAY;
+        case GL_UNIFORM_BUFFER: return SLOT_UNIFORM;
+        case GL_PIXEL_PACK_BUFFER: return SLOT_PIXEL_PACK;
+        case GL_PIXEL_UNPACK_BUFFER: return SLOT_PIXEL_UNPACK;
+        case GL_DRAW_INDIRECT_BUFFER: return SLOT_DRAW_INDIRECT;
+        case GL_TEXTURE_BUFFER: return SLOT_TEXTURE;
+        default: return -1;
+        }
+    }
+
+    int textureSlotOf(GLenum target)
+    {
+        switch (target) {
+        case GL_TEXTURE_2D: return TEXTURE_SLOT_2D;
+        case GL_TEXTURE_BUFFER: return TEXTURE_SLOT_BUFFER;
+        default: return -1;
+        }
+    }
+
+    bool skip()
+    {
+        state.frame.skipped++;
+        return true;
+    }
+
+    void issue()
+    {
+        state.frame.issued++;
+    }
+}
+
+void GLState::useProgram(GLuint program)
+{
+    if (state.program == program && skip()) return;
+
+    glUseProgram(program);
+    state.program = program;
+    issue();
+}
+
+void GLState::bindVertexArray(GLuint vao)
+{
+    if (state.vao == vao && skip()) return;
+
+    glBindVertexArray(vao);
+    state.vao = vao;
+    issue();
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer)
+{
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        if (state.vao != UNKNOWN) {
+            auto it = state.vao_element_buffer.find(state.vao);
+            if (it != state.vao_element_buffer.end() && it->second == buffer && skip()) return;
+        }
+
+        glBindBuffer(target, buffer);
+        if (state.vao != UNKNOWN) state.vao_element_buffer[state.vao] = buffer;
+        issue();
+        return;
+    }
+
+    int slot = slotOf(target);
+    if (slot >= 0 && state.buffers[slot] == buffer && skip()) return;
+
+    glBindBuffer(target, buffer);
+    if (slot >= 0) state.buffers[slot] = buffer;
+    issue();
+}
+
+void GLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    // indexed bindings aren't cached, but they also replace the generic binding
+    glBindBufferBase(target, index, buffer);
+
+    int slot = slotOf(target);
+    if (slot >= 0) state.buffers[slot] = buffer;
+    issue();
+}
+
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    int slot = unit < NUM_TEXTURE_UNITS ? textureSlotOf(target) : -1;
+    if (slot >= 0 && state.textures[unit][slot] == texture && skip()) return;
+
+    if (state.active_texture_unit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        state.active_texture_unit = unit;
+        issue();
+    }
+
+    glBindTexture(target, texture);
+    if (slot >= 0) state.textures[unit][slot] = texture;
+    issue();
+}
+
+void GLState::bindFramebuffer(GLuint framebuffer)
+{
+    if (state.framebuffer == framebuffer && skip()) return;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    state.framebuffer = framebuffer;
+    issue();
+}
+
+void GLState::clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    GLfloat color[4] = { r, g, b, a };
+    if (state.clear_color_known && memcmp(state.clear_color, color, sizeof(color)) == 0 && skip()) return;
+
+    glClearColor(r, g, b, a);
+    memcpy(state.clear_color, color, sizeof(color));
+    state.clear_color_known = true;
+    issue();
+}
+
+void GLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    GLint vp[4] = { x, y, width, height };
+    if (state.viewport_known && memcmp(state.viewport, vp, sizeof(vp)) == 0 && skip()) return;
+
+    glViewport(x, y, width, height);
+    memcpy(state.viewport, vp, sizeof(vp));
+    state.viewport_known = true;
+    issue();
+}
+
+void GLState::invalidate()
+{
+    state.reset();
+}
+
+void GLState::beginFrame()
+{
+    state.last_frame = state.frame;
+    state.frame = GLStateStats();
+}
+
+const GLStateStats& GLState::getFrameStats()
+{
+    return state.frame;
+}
+
+const GLStateStats& GLState::getLastFrameStats()
+{
+    return state.last_frame;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef GL_STATE_HPP
+#define GL_STATE_HPP
+
+#include <GL/glew.h>
+
+struct GLStateStats
+{
+    unsigned issued = 0;
+    unsigned skipped = 0;
+};
+
+// Shadows the bits of GL state the game touches and drops calls that would
+// not change anything. All binds and state changes should go through here,
+// otherwise call invalidate() so the cache is re-read from scratch.
+namespace GLState {
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    void bindBuffer(GLenum target, GLuint buffer);
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+    // Makes unit the active texture unit if needed, then binds texture to it.
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    // Binds to GL_FRAMEBUFFER, i.e. both the draw and read targets.
+    void bindFramebuffer(GLuint framebuffer);
+    void clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    // Call when buffers/programs are deleted or GL is used behind the tracker's back.
+    void invalidate();
+
+    // Starts a new frame's counters; the finished frame stays readable via getLastFrameStats.
+    void beginFrame();
+    const GLStateStats& getFrameStats();
+    const GLStateStats& getLastFrameStats();
+};
+
+#endif
\ No newline at end of file
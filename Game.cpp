@@ -0,0 +1,737 @@
+#include "Game.hpp"
+#include <cstdio>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "GLState.hpp"
+#include "Profiler.hpp"
+#include "MatchRunner.hpp"
+#include "InterceptAI.hpp"
+
+static const char *SHADER_CACHE_PATH = "simplepong_shaders.bin";
+static const char *TEXT_SHADER_CACHE_PATH = "simplepong_text_shaders.bin";
+
+static std::vector<Rectangle2D> createLines(GLfloat width, GLfloat height, int num_lines)
+{
+    std::vector<Rectangle2D> line_rects;
+
+    GLfloat gap = 0.2f;
+
+    GLfloat curr_offset = 0.0f;
+
+    for (int i = 0; i < num_lines; i++) {
+        Rectangle2D rect(width, height, { 0.0f, 2.0f - height / 2.0f - curr_offset });
+        line_rects.emplace_back(rect);
+        curr_offset += height + gap;
+    }
+
+    return line_rects;
+}
+
+void initWindowArgs()
+{
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+}
+
+void initMainWindow(GLFWwindow *main_window, GameContext &ctx)
+{
+    glfwGetFramebufferSize(main_window, &ctx.buffer_width, &ctx.buffer_height);
+    glfwMakeContextCurrent(main_window);
+
+    GLState::viewport(0, 0, ctx.buffer_width, ctx.buffer_height);
+
+    glfwSetWindowUserPointer(main_window, &ctx);
+}
+
+static void drawGameObjects(GameContext &ctx)
+{
+    ctx.frame_uniforms.update(glm::value_ptr(ctx.view_projection), sizeof(glm::mat4));
+    ctx.shader_handler.setUniform("color", glm::vec4(.7f, .7f, .7f, 1.0f));
+
+    ctx.renderer.begin();
+
+    ctx.renderer.add(ctx.p1);
+    ctx.renderer.add(ctx.p2);
+    ctx.renderer.add(ctx.ball);
+
+    for (Rectangle2D& line : ctx.lines) {
+        ctx.renderer.add(line);
+    }
+
+    ctx.renderer.draw();
+}
+
+static void drawStressObjects(GameContext &ctx)
+{
+    ctx.frame_uniforms.update(glm::value_ptr(ctx.view_projection), sizeof(glm::mat4));
+    ctx.shader_handler.setUniform("color", glm::vec4(.7f, .7f, .7f, 1.0f));
+
+    ctx.renderer.begin();
+
+    for (const Rectangle2D &rect : ctx.stress.getObstacles()) {
+        ctx.renderer.add(rect);
+    }
+
+    // balls are drawn at their latest tick; interpolating thousands of them
+    // would need a second copy of the world
+    float size = ctx.stress.getConfig().ball_size;
+    for (const StressBall &ball : ctx.stress.getBalls()) {
+        ctx.renderer.add(ball.position.x, ball.position.y, size, size);
+    }
+
+    ctx.renderer.draw();
+}
+
+static void drawWallObjects(GameContext &ctx)
+{
+    ctx.frame_uniforms.update(glm::value_ptr(ctx.view_projection), sizeof(glm::mat4));
+    ctx.shader_handler.setUniform("color", glm::vec4(.7f, .7f, .7f, 1.0f));
+
+    ctx.wall.draw(ctx.renderer, ctx.shader_handler);
+}
+
+static void drawHud(GameContext &ctx)
+{
+    constexpr GLfloat SCORE_SCALE = 6.0f;
+    constexpr GLfloat STATS_SCALE = 2.0f;
+    constexpr GLfloat LINE_HEIGHT = (TextRenderer::GLYPH_HEIGHT + 2) * STATS_SCALE;
+    constexpr int MAX_ZONES = 8;
+
+    int width = ctx.offscreen ? ctx.win_width : ctx.buffer_width;
+    int height = ctx.offscreen ? ctx.win_height : ctx.buffer_height;
+
+    // smoothed, the raw per-frame rate flickers too much to read
+    if (ctx.delta_time > 0.0) {
+        double fps = 1.0 / ctx.delta_time;
+        ctx.fps = ctx.fps > 0.0 ? ctx.fps * 0.95 + fps * 0.05 : fps;
+    }
+
+    ctx.text.begin(width, height);
+
+    if (!ctx.stress_mode && !ctx.wall_mode) {
+        char score[32];
+        snprintf(score, sizeof(score), "%u   %u", ctx.sim.score_player_1, ctx.sim.score_player_2);
+        ctx.text.add(((GLfloat)width - TextRenderer::measure(score, SCORE_SCALE)) * 0.5f, 16.0f, SCORE_SCALE, score);
+    }
+
+    if (ctx.show_stats) {
+        GLfloat y = 8.0f;
+        const GLStateStats &gl_stats = GLState::getLastFrameStats();
+
+        ctx.text.print(8.0f, y, STATS_SCALE, "%.0f fps  %.2f ms", ctx.fps, ctx.delta_time * 1e3);
+        y += LINE_HEIGHT;
+        ctx.text.print(8.0f, y, STATS_SCALE, "%u rects in %u draws", ctx.renderer.getNumInstances(), ctx.renderer.getDrawCalls());
+        y += LINE_HEIGHT;
+        ctx.text.print(8.0f, y, STATS_SCALE, "gl calls %u issued %u skipped", gl_stats.issued, gl_stats.skipped);
+        y += LINE_HEIGHT;
+
+        ProfileZoneTime zones[MAX_ZONES];
+        int num_zones = Profiler::getLatestZones(zones, MAX_ZONES);
+
+        for (int i = 0; i < num_zones; i++, y += LINE_HEIGHT) {
+            ctx.text.print(8.0f, y, STATS_SCALE, "%s%s %.3f ms", zones[i].name, zones[i].gpu ? " gpu" : "", zones[i].ms);
+        }
+    }
+
+    ctx.text.draw();
+}
+
+static void syncRectangle(Rectangle2D &rect, const SimBody &prev, const SimBody &curr, float alpha)
+{
+    SimVec2 position = Simulation::interpolate(prev, curr, alpha);
+    rect.position = { position.x, position.y };
+}
+
+static int8_t keyDirection(const bool *keys_down, int up_key, int down_key)
+{
+    if (keys_down[up_key] == keys_down[down_key]) return 0;
+    return keys_down[up_key] ? 1 : -1;
+}
+
+static void applyInputEvent(GameContext &ctx, const InputEvent &event)
+{
+    if (event.key < 0 || event.key > GLFW_KEY_LAST) return;
+
+    ctx.keys_down[event.key] = event.action == GLFW_PRESS;
+    ctx.last_key_ns = event.time_ns;
+
+    if (ctx.attract && event.action == GLFW_PRESS) {
+        ctx.attract = false;
+        printf("Attract mode off\n");
+    }
+
+    SimInputs inputs = ctx.inputs;
+
+    // with both keys held the paddle keeps its last direction
+    if (!ctx.keys_down[GLFW_KEY_W] || !ctx.keys_down[GLFW_KEY_S]) {
+        inputs.p1_dir = keyDirection(ctx.keys_down, GLFW_KEY_W, GLFW_KEY_S);
+    }
+    if (!ctx.keys_down[GLFW_KEY_UP] || !ctx.keys_down[GLFW_KEY_DOWN]) {
+        inputs.p2_dir = keyDirection(ctx.keys_down, GLFW_KEY_UP, GLFW_KEY_DOWN);
+    }
+
+    if (ctx.latency_mode && ctx.latency_pending_ns == 0 &&
+        (inputs.p1_dir != ctx.inputs.p1_dir || inputs.p2_dir != ctx.inputs.p2_dir)) {
+        ctx.latency_pending_ns = event.time_ns;
+    }
+
+    ctx.inputs = inputs;
+}
+
+static void startLiveMatch(GameContext &ctx)
+{
+    Simulation::init(ctx.sim);
+    ctx.prev_sim = ctx.sim;
+
+    ctx.timestep.setTickRate(GameConstants::SIM_TICK_RATE);
+    ctx.recorder.begin(ctx.sim.config, 0, ctx.timestep.getTickRate());
+}
+
+static void finishReplay(GameContext &ctx)
+{
+    const ReplayHeader &header = ctx.replay_file.getView().header;
+
+    if (ctx.replay_player.isCorrupt()) {
+        printf("Replay stopped at tick %llu: corrupt input stream\n", (unsigned long long)ctx.replay_player.getTick());
+    } else if (Simulation::hashState(ctx.sim) != header.final_hash) {
+        printf("Replay finished after %llu ticks but diverged from the recording\n", (unsigned long long)ctx.sim.tick);
+    } else {
+        printf("Replay finished after %llu ticks, final state matches\n", (unsigned long long)ctx.sim.tick);
+    }
+
+    ctx.replaying = false;
+    ctx.replay_file.close();
+
+    ctx.inputs.p1_dir = keyDirection(ctx.keys_down, GLFW_KEY_W, GLFW_KEY_S);
+    ctx.inputs.p2_dir = keyDirection(ctx.keys_down, GLFW_KEY_UP, GLFW_KEY_DOWN);
+
+    startLiveMatch(ctx);
+}
+
+bool startReplay(GameContext &ctx, const char *path)
+{
+    if (!ctx.replay_file.open(path)) return false;
+
+    const ReplayView &view = ctx.replay_file.getView();
+
+    Simulation::init(ctx.sim, view.header.config);
+    ctx.prev_sim = ctx.sim;
+
+    ctx.timestep.setTickRate(view.header.tick_rate);
+    ctx.replay_player.begin(view);
+    ctx.replaying = true;
+
+    // a partial live recording can't be replayed, drop it
+    ctx.recorder.finish(ctx.sim);
+    return true;
+}
+
+bool saveReplay(GameContext &ctx, const char *path)
+{
+    if (!ctx.recorder.isRecording()) return false;
+
+    ctx.recorder.finish(ctx.sim);
+    return ctx.recorder.save(path);
+}
+
+void startNetplay(GameContext &ctx, RollbackSession *session)
+{
+    ctx.netplay = session;
+    ctx.sim = session->getState();
+    ctx.prev_sim = ctx.sim;
+
+    // the session has its own input history, the recorder's would be wrong
+    ctx.recorder.finish(ctx.sim);
+}
+
+void startStress(GameContext &ctx, uint32_t num_balls)
+{
+    StressConfig config;
+    config.num_balls = num_balls;
+
+    ctx.stress.init(config, StressWorld::defaultObstacles());
+    ctx.stress_mode = true;
+
+    // nothing to replay in stress mode
+    ctx.recorder.finish(ctx.sim);
+}
+
+void startWall(GameContext &ctx, uint32_t num_matches)
+{
+    ctx.wall.init(num_matches, ctx.shader_handler);
+    ctx.wall_mode = true;
+
+    // the wall isn't recorded either
+    ctx.recorder.finish(ctx.sim);
+}
+
+void updateGame(GameContext &ctx, double frame_dt)
+{
+    int ticks = ctx.timestep.advance(frame_dt);
+
+    if (ctx.last_key_ns == 0) ctx.last_key_ns = ctx.last_frame_ns;
+
+    bool live = !ctx.replaying && !ctx.netplay && !ctx.stress_mode && !ctx.wall_mode && !ctx.offscreen;
+    if (live && !ctx.attract && ctx.last_frame_ns - ctx.last_key_ns > (uint64_t)GameConstants::ATTRACT_AFTER_SECONDS * 1000000000ull) {
+        ctx.attract = true;
+        printf("Attract mode on, press any key to play\n");
+    }
+
+    // tick i covers the real time up to its end stamp; whatever the
+    // accumulator still holds belongs to the next frame
+    int64_t tick_ns = (int64_t)(ctx.timestep.getTickDt() * 1e9);
+    int64_t leftover_ns = (int64_t)(ctx.timestep.getAlpha() * (double)tick_ns);
+    int64_t tick_end_ns = (int64_t)ctx.last_frame_ns - leftover_ns - (int64_t)(ticks - 1) * tick_ns;
+
+    InputEvent event;
+
+    for (int i = 0; i < ticks; i++, tick_end_ns += tick_ns) {
+        while (ctx.input_queue.peek(event) && (int64_t)event.time_ns <= tick_end_ns) {
+            applyInputEvent(ctx, event);
+            ctx.input_queue.pop();
+        }
+
+        if (ctx.stress_mode) {
+            ctx.stress.step(ctx.timestep.getTickDt());
+            continue;
+        }
+
+        if (ctx.wall_mode) {
+            ctx.wall.step(ctx.timestep.getTickDt());
+            continue;
+        }
+
+        // the AI decides per tick, so it sees every tick's state like a bot would
+        if (ctx.attract) {
+            ctx.inputs = InterceptAI::decideBoth(ctx.sim, InterceptAIConfig(), ctx.bot_rng);
+        } else if (ctx.ai_player_2 && !ctx.replaying && !ctx.netplay) {
+            ctx.inputs.p2_dir = InterceptAI::decideBoth(ctx.sim, InterceptAIConfig(), ctx.bot_rng).p2_dir;
+        }
+
+        if (ctx.replaying && !ctx.replay_player.next(ctx.inputs)) {
+            finishReplay(ctx);
+            break;
+        }
+
+        ctx.prev_sim = ctx.sim;
+        uint32_t events = SIM_EVENT_NONE;
+
+        if (ctx.netplay) {
+            int8_t dir = ctx.inputs.p1_dir ? ctx.inputs.p1_dir : ctx.inputs.p2_dir;
+
+            // a stalled tick leaves the state as is until the peer catches up
+            ctx.netplay->advance(dir, events);
+            ctx.sim = ctx.netplay->getState();
+        } else {
+            ctx.recorder.record(ctx.inputs);
+            events = Simulation::step(ctx.sim, ctx.inputs, ctx.timestep.getTickDt());
+        }
+
+        if (events & SIM_EVENT_ROUND_RESET) {
+            // don't blend the ball across the field back to its spawn point
+            ctx.prev_sim.ball = ctx.sim.ball;
+        }
+    }
+}
+
+void renderGame(GameContext &ctx)
+{
+    GLState::clearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    ctx.shader_handler.enableShaders();
+
+    if (ctx.stress_mode) {
+        drawStressObjects(ctx);
+    } else if (ctx.wall_mode) {
+        drawWallObjects(ctx);
+    } else {
+        GLfloat alpha = ctx.timestep.getAlpha();
+
+        syncRectangle(ctx.p1, ctx.prev_sim.p1, ctx.sim.p1, alpha);
+        syncRectangle(ctx.p2, ctx.prev_sim.p2, ctx.sim.p2, alpha);
+        syncRectangle(ctx.ball, ctx.prev_sim.ball, ctx.sim.ball, alpha);
+
+        drawGameObjects(ctx);
+    }
+
+    // text has its own program, which the next frame's enableShaders replaces
+    drawHud(ctx);
+}
+
+static void recordInputLatency(GameContext &ctx)
+{
+    // wait for the frame to actually finish so the sample covers the GPU too
+    glFinish();
+
+    if (ctx.latency_pending_ns == 0) return;
+
+    double ms = (double)(InputQueue::nowNs() - ctx.latency_pending_ns) / 1e6;
+    ctx.latency_pending_ns = 0;
+
+    InputLatencyStats &stats = ctx.latency;
+    stats.samples++;
+    stats.total_ms += ms;
+    stats.last_ms = ms;
+    if (ms > stats.max_ms) stats.max_ms = ms;
+}
+
+static void printInputLatency(const InputLatencyStats &stats)
+{
+    if (stats.samples == 0) {
+        printf("Input latency: no samples\n");
+        return;
+    }
+
+    printf("Input latency over %llu samples: %.2f ms avg, %.2f ms max, %.2f ms last\n",
+           (unsigned long long)stats.samples, stats.total_ms / (double)stats.samples, stats.max_ms, stats.last_ms);
+}
+
+// Nothing on screen changes until a key is pressed: the window is minimised,
+// or the ball is parked for the serve with more than an idle frame to go and
+// both paddles are still.
+static bool isIdle(const GameContext &ctx)
+{
+    if (glfwGetWindowAttrib(ctx.main_window, GLFW_ICONIFIED)) return true;
+    if (ctx.replaying || ctx.netplay || ctx.stress_mode || ctx.wall_mode || ctx.latency_mode) return false;
+
+    return ctx.sim.phase == MatchPhase::Serving &&
+           ctx.sim.phase_timer > (float)(1.0 / FramePacer::IDLE_RATE) &&
+           ctx.inputs.p1_dir == 0 && ctx.inputs.p2_dir == 0;
+}
+
+static void printFramePacing(const FramePacer &pacer)
+{
+    const FramePacingStats &stats = pacer.getStats();
+
+    printf("Frame pacing (vsync %s, target %.0f fps): %llu frames, %.3f ms avg, %.3f ms jitter, %.3f ms max, %llu missed, %llu idle\n",
+           FramePacer::getVsyncName(pacer.getVsync()), pacer.getTargetRate(),
+           (unsigned long long)stats.frames, stats.mean_interval_ms, stats.jitter_ms, stats.max_interval_ms,
+           (unsigned long long)stats.missed_deadlines, (unsigned long long)stats.idle_frames);
+    printf("Frame pacing waits: %.1f ms asleep, %.1f ms spinning\n", stats.sleep_ms, stats.spin_ms);
+}
+
+static void reportFirstFrame(GameContext &ctx)
+{
+    if (ctx.startup_ns == 0) return;
+
+    // the frame only counts once the GPU is done with it
+    glFinish();
+    printf("Startup: %.2f ms to first frame\n", (double)(InputQueue::nowNs() - ctx.startup_ns) / 1e6);
+    ctx.startup_ns = 0;
+}
+
+void runGameLoop(GameContext &ctx)
+{
+    // wait before polling, so the input this frame acts on is as fresh as possible
+    {
+        PROFILE_ZONE("framePacing");
+        ctx.pacer.wait(isIdle(ctx));
+    }
+
+    GLState::beginFrame();
+
+    // sample input as late as possible: poll first, then stamp the frame so
+    // every event just delivered falls inside this frame's ticks
+    {
+        PROFILE_ZONE("glfwPollEvents");
+        glfwPollEvents();
+    }
+
+    uint64_t curr_frame_ns = InputQueue::nowNs();
+    ctx.delta_time = (double)(curr_frame_ns - ctx.last_frame_ns) / 1e9;
+    ctx.last_frame_ns = curr_frame_ns;
+
+    {
+        PROFILE_ZONE("physics");
+        updateGame(ctx, ctx.delta_time);
+    }
+
+    {
+        PROFILE_GPU_ZONE("drawGameObjects");
+        renderGame(ctx);
+    }
+
+    {
+        PROFILE_ZONE("glfwSwapBuffers");
+        glfwSwapBuffers(ctx.main_window);
+    }
+
+    reportFirstFrame(ctx);
+
+    if (ctx.latency_mode) {
+        PROFILE_ZONE("inputLatency");
+        recordInputLatency(ctx);
+    }
+
+    PROFILE_FRAME();
+}
+
+bool initOffscreen(GameContext &ctx, const char *capture_path)
+{
+    if (!ctx.offscreen_target.create(ctx.win_width, ctx.win_height)) return false;
+    ctx.offscreen = true;
+
+    if (capture_path) {
+        if (!ctx.frame_sink.open(capture_path)) return false;
+
+        ctx.frame_capture.create(ctx.win_width, ctx.win_height, &ctx.frame_sink);
+        ctx.capturing = true;
+    }
+
+    return true;
+}
+
+void runOffscreenFrame(GameContext &ctx, double frame_dt)
+{
+    GLState::beginFrame();
+
+    if (!ctx.replaying) ctx.inputs = MatchControllers::trackBall(ctx.sim, ctx.bot_rng);
+
+    ctx.last_frame_ns += (uint64_t)(frame_dt * 1e9);
+
+    {
+        PROFILE_ZONE("physics");
+        updateGame(ctx, frame_dt);
+    }
+
+    ctx.offscreen_target.bind();
+
+    {
+        PROFILE_GPU_ZONE("drawGameObjects");
+        renderGame(ctx);
+    }
+
+    reportFirstFrame(ctx);
+
+    if (ctx.capturing) {
+        PROFILE_ZONE("capture");
+        ctx.frame_capture.capture();
+    }
+
+    PROFILE_FRAME();
+}
+
+void finishOffscreen(GameContext &ctx)
+{
+    if (ctx.capturing) {
+        ctx.frame_capture.finish();
+
+        const CaptureStats &stats = ctx.frame_capture.getStats();
+        printf("Captured %llu frames (%llu readback stalls)\n", (unsigned long long)stats.frames, (unsigned long long)stats.stalls);
+
+        ctx.frame_capture.destroy();
+        ctx.frame_sink.close();
+        ctx.capturing = false;
+    }
+
+    ctx.offscreen_target.destroy();
+    ctx.offscreen = false;
+}
+
+void handleKeys(GLFWwindow* window, int key, int /*code*/, int action, int /*mode*/)
+{
+    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
+        glfwSetWindowShouldClose(window, GL_TRUE);
+    }
+
+    GameContext &ctx = *static_cast<GameContext *>(glfwGetWindowUserPointer(window));
+
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+        const GLStateStats &stats = GLState::getLastFrameStats();
+        printf("GL state calls last frame: %u issued, %u skipped\n", stats.issued, stats.skipped);
+
+        const StreamingStats &streaming = ctx.renderer.getLastFrameStreamingStats();
+        printf("Streamed last frame: %ld bytes, %u waits, %u orphans\n", (long)streaming.upload_bytes, streaming.waits, streaming.orphans);
+
+        if (ctx.netplay) {
+            const RollbackStats &rollback = ctx.netplay->getStats();
+            printf("Rollback: %llu rollbacks, %llu ticks resimulated, %u max, %llu stalls\n",
+                   (unsigned long long)rollback.rollbacks, (unsigned long long)rollback.resimulated_ticks,
+                   rollback.max_rollback_ticks, (unsigned long long)rollback.stalls);
+        }
+
+        if (ctx.stress_mode) {
+            const StressStats &stress = ctx.stress.getStats();
+            double ticks = stress.ticks ? (double)stress.ticks : 1.0;
+            printf("Stress: %zu balls, %.1f pair tests, %.1f ball hits, %.1f cell moves per tick\n",
+                   ctx.stress.getBalls().size(), (double)stress.pair_tests / ticks,
+                   (double)stress.ball_hits / ticks, (double)stress.cell_moves / ticks);
+        }
+
+        if (ctx.wall_mode) {
+            printf("Wall: %zu matches in %d x %d tiles, %u rects in %u draw calls\n",
+                   ctx.wall.size(), ctx.wall.getColumns(), ctx.wall.getRows(),
+                   ctx.renderer.getNumInstances(), ctx.renderer.getDrawCalls());
+        }
+
+        printFramePacing(ctx.pacer);
+
+        if (ctx.latency_mode) printInputLatency(ctx.latency);
+    }
+
+    if (key == GLFW_KEY_F2 && action == GLFW_PRESS) {
+        Profiler::writeChromeTrace("simplepong_trace.json");
+    }
+
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS) {
+        ctx.latency_mode = !ctx.latency_mode;
+        ctx.latency_pending_ns = 0;
+
+        if (ctx.latency_mode) {
+            ctx.latency = InputLatencyStats();
+            printf("Input latency measurement on\n");
+        } else {
+            printInputLatency(ctx.latency);
+        }
+    }
+
+    if (key == GLFW_KEY_F5 && action == GLFW_PRESS) {
+        VsyncMode mode = (VsyncMode)(((int)ctx.pacer.getVsync() + 1) % 3);
+        ctx.pacer.setVsync(mode);
+        ctx.pacer.resetStats();
+        printf("Vsync %s\n", FramePacer::getVsyncName(mode));
+    }
+
+    if (key == GLFW_KEY_F6 && action == GLFW_PRESS) {
+        ctx.show_stats = !ctx.show_stats;
+    }
+
+    if (key < 0 || key > GLFW_KEY_LAST || action == GLFW_REPEAT) return;
+
+    // GLFW delivers events from glfwPollEvents, so this is the time the
+    // event was dequeued rather than the OS timestamp
+    InputEvent event;
+    event.time_ns = InputQueue::nowNs();
+    event.key = key;
+    event.action = action;
+
+    if (!ctx.input_queue.push(event)) {
+        printf("Input queue full, dropping key %d\n", key);
+    }
+}
+
+void loadGameShaders(ShaderHandler &shader_handler, const char *cache_path)
+{
+    static const char* vertex_shader_code = "                                                               \n\
+    #version 330                                                                                            \n\
+                                                                                                            \n\
+    layout(location = 0) in vec2 pos;                                                                       \n\
+    layout(location = 1) in vec4 rect;                                                                      \n\
+                                                                                                            \n\
+    layout(std140) uniform Frame                                                                            \n\
+    {                                                                                                       \n\
+        mat4 view_projection;                                                                               \n\
+    };                                                                                                      \n\
+                                                                                                            \n\
+    // with rects_per_match > 0 every group of that many instances is one match,                            \n\
+    // placed by its (offset, scale) tile from the buffer                                                   \n\
+    uniform int rects_per_match;                                                                            \n\
+    uniform samplerBuffer tiles;                                                                            \n\
+                                                                                                            \n\
+    void main()                                                                                             \n\
+    {                                                                                                       \n\
+        vec2 p = rect.xy + pos * rect.zw;                                                                   \n\
+        if (rects_per_match > 0) {                                                                          \n\
+            vec4 tile = texelFetch(tiles, gl_InstanceID / rects_per_match);                                 \n\
+            p = tile.xy + p * tile.zw;                                                                      \n\
+        }                                                                                                   \n\
+                                                                                                            \n\
+        gl_Position = view_projection * vec4(p, 0.0, 1.0);                                                  \n\
+    }                                                                                                       \n\
+    ";
+    
+    // fragment shader
+    static const char* fragment_shader_code = "                     \n\
+    #version 330                                                    \n\
+                                                                    \n\
+    uniform vec4 color;                                             \n\
+                                                                    \n\
+    out vec4 frag_color;                                            \n\
+                                                                    \n\
+    void main()                                                     \n\
+    {                                                               \n\
+        frag_color = color;                                         \n\
+    }                                                               \n\
+    ";
+
+    Shader v_shader{ 0, GL_VERTEX_SHADER, vertex_shader_code };
+    Shader f_shader{ 0, GL_FRAGMENT_SHADER, fragment_shader_code };
+
+    shader_handler.add(v_shader);
+    shader_handler.add(f_shader);
+
+    if (cache_path) shader_handler.setBinaryCache(cache_path);
+
+    shader_handler.compileShaders();
+    shader_handler.linkShaders();
+}
+
+void initGameShaders(GameContext &ctx)
+{
+    ctx.shader_handler.validateShaders();
+
+    ctx.frame_uniforms.create(0, sizeof(glm::mat4));
+    ctx.shader_handler.bindUniformBlock("Frame", ctx.frame_uniforms.getBinding());
+}
+
+void initGameObjects(GameContext &ctx)
+{
+    using namespace GameConstants;
+
+    ctx.p1 = Rectangle2D(PLAYER_1_WIDTH, PLAYER_1_HEIGHT, { PLAYER_1_POS_INITIAL[0], PLAYER_1_POS_INITIAL[1] } );
+    ctx.p2 = Rectangle2D(PLAYER_2_WIDTH, PLAYER_2_HEIGHT, { PLAYER_2_POS_INITIAL[0], PLAYER_2_POS_INITIAL[1] } );
+    ctx.ball = Rectangle2D(BALL_WIDTH, BALL_HEIGHT, { BALL_POS_INITIAL[0], BALL_POS_INITIAL[0] } );
+    ctx.lines = createLines(LINES_WIDTH, LINES_HEIGHT, NUM_LINES);
+
+    startLiveMatch(ctx);
+}
+
+glm::mat4 initViewProjectionMatrix(GameContext &ctx) 
+{
+    glm::vec3 camera_pos = glm::vec3(0.0f, 0.0f, 1.0f);
+    glm::vec3 camera_target = glm::vec3(0.0f, 0.0f, 0.0f);
+    glm::vec3 up_vector = glm::vec3(0.0f, 1.0f, 0.0f);
+
+    glm::mat4 view = glm::lookAt(camera_pos, camera_target, up_vector);
+
+    glm::mat4 projection = glm::ortho(ctx.proj_down, ctx.proj_up, ctx.proj_left, ctx.proj_right, ctx.proj_near, ctx.proj_far);
+
+    glm::mat4 view_projection = projection * view;
+
+    return view_projection;
+}
+
+void initGame(GameContext &ctx)
+{
+    uint64_t start_ns = InputQueue::nowNs();
+
+    ctx.view_projection = initViewProjectionMatrix(ctx);
+
+    glewExperimental = GL_TRUE;
+    glewInit();
+
+    // kick off the shader build first so the driver compiles while we set up the rest
+    uint64_t shaders_start_ns = InputQueue::nowNs();
+    loadGameShaders(ctx.shader_handler, SHADER_CACHE_PATH);
+    uint64_t shaders_issued_ns = InputQueue::nowNs();
+
+    initGameObjects(ctx);
+
+    ctx.renderer.init();
+    ctx.text.init(TEXT_SHADER_CACHE_PATH);
+
+    uint64_t wait_start_ns = InputQueue::nowNs();
+    initGameShaders(ctx);
+    uint64_t end_ns = InputQueue::nowNs();
+
+    printf("initGame: %.2f ms (shaders %s: %.2f ms issue + %.2f ms wait)\n",
+           (double)(end_ns - start_ns) / 1e6,
+           ctx.shader_handler.isLoadedFromCache() ? "from cache" : "compiled",
+           (double)(shaders_issued_ns - shaders_start_ns) / 1e6,
+           (double)(end_ns - wait_start_ns) / 1e6);
+}
\ No newline at end of file
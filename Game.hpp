@@ -0,0 +1,158 @@
+#ifndef GAME_HPP
+#define GAME_HPP
+
+#include <vector>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include "Shader.hpp"
+#include "RectangleRenderer.hpp"
+#include "TextRenderer.hpp"
+#include "UniformBuffer.hpp"
+#include "Shapes2D.hpp"
+#include "Simulation.hpp"
+#include "FixedTimestep.hpp"
+#include "InputQueue.hpp"
+#include "Replay.hpp"
+#include "FrameCapture.hpp"
+#include "Rollback.hpp"
+#include "StressWorld.hpp"
+#include "MatchWall.hpp"
+#include "FramePacer.hpp"
+
+struct GameContext
+{
+    const GLint win_width  = 1000;
+    const GLint win_height = 800;
+
+    glm::mat4 view_projection;
+
+    GLFWwindow* main_window = nullptr;
+    int buffer_width = 1;
+    int buffer_height = 1;
+
+    SimState sim;
+    SimState prev_sim;
+    SimInputs inputs;
+    FixedTimestep timestep;
+
+    InputQueue input_queue;
+    bool keys_down[GLFW_KEY_LAST + 1] = {};
+
+    // the live match is always recorded; a loaded replay drives the inputs instead
+    ReplayRecorder recorder;
+    ReplayFile replay_file;
+    ReplayPlayer replay_player;
+    bool replaying = false;
+
+    // versus play over the network; the session owns the authoritative state
+    // and ctx.sim mirrors it after every tick
+    RollbackSession *netplay = nullptr;
+
+    // offscreen mode renders into an FBO, the paddles are played by bots
+    // unless a replay is running, and frames can be captured to a sink
+    bool offscreen = false;
+    bool capturing = false;
+    OffscreenTarget offscreen_target;
+    FrameSink frame_sink;
+    FrameCapture frame_capture;
+    uint64_t bot_rng = 1;
+
+    // InterceptAI plays player 2 with --ai, and both paddles in attract mode,
+    // which starts after ATTRACT_AFTER_SECONDS without a key press
+    bool ai_player_2 = false;
+    bool attract = false;
+    uint64_t last_key_ns = 0;
+
+    // stress mode replaces the match with a StressWorld full of balls
+    bool stress_mode = false;
+    StressWorld stress;
+
+    // wall mode shows a grid of AI matches instead of the match
+    bool wall_mode = false;
+    MatchWall wall;
+
+    Rectangle2D p1;
+    Rectangle2D p2;
+    Rectangle2D ball;
+
+    std::vector<Rectangle2D> lines;
+    
+    RectangleRenderer renderer;
+
+    // the HUD: scores, plus frame stats and profiler zones when toggled with F6
+    TextRenderer text;
+    bool show_stats = false;
+    double fps = 0.0;
+
+    ShaderHandler shader_handler;
+    UniformBuffer frame_uniforms;
+
+    GLfloat proj_up = 2.0f;
+    GLfloat proj_down = -2.0f;
+
+    GLfloat proj_right = 2.0f;
+    GLfloat proj_left = -2.0f;
+
+    GLfloat proj_near = -1.0f;
+    GLfloat proj_far = 1.0f;
+
+    FramePacer pacer;
+
+    // on the InputQueue clock, so key events line up with simulation ticks
+    uint64_t last_frame_ns = 0;
+
+    // process start, reported and cleared once the first frame is finished
+    uint64_t startup_ns = 0;
+    double delta_time = 0.0;
+
+    bool latency_mode = false;
+    uint64_t latency_pending_ns = 0;
+    InputLatencyStats latency;
+};
+
+void initWindowArgs();
+void initMainWindow(GLFWwindow *main_window, GameContext &ctx);
+
+// Everything that needs a current GL context: GLEW, objects, buffers and shaders.
+void initGame(GameContext &ctx);
+
+void initGameObjects(GameContext &ctx);
+void initGameShaders(GameContext &ctx);
+// Issues the shader compile and link without waiting for them, optionally
+// through a program binary cache. validateShaders finishes the job.
+void loadGameShaders(ShaderHandler &shader_handler, const char *cache_path = nullptr);
+glm::mat4 initViewProjectionMatrix(GameContext &ctx);
+
+// Runs the fixed-step simulation for frame_dt seconds of real time ending at
+// ctx.last_frame_ns, applying each queued key event on the tick it happened in.
+void updateGame(GameContext &ctx, double frame_dt);
+void renderGame(GameContext &ctx);
+
+// Plays a replay file back in real time. The live match resumes from a fresh
+// start once it ends.
+bool startReplay(GameContext &ctx, const char *path);
+bool saveReplay(GameContext &ctx, const char *path);
+
+// Hands the match to a rollback session. The local player steers with
+// either key pair.
+void startNetplay(GameContext &ctx, RollbackSession *session);
+
+// Swaps the match for a field of num_balls bouncing balls and obstacles.
+void startStress(GameContext &ctx, uint32_t num_balls);
+
+// Swaps the match for a wall of num_matches AI matches drawn in one pass.
+void startWall(GameContext &ctx, uint32_t num_matches);
+void runGameLoop(GameContext &ctx);
+
+// capture_path may be null to render offscreen without capturing.
+bool initOffscreen(GameContext &ctx, const char *capture_path);
+
+// Advances by a fixed frame_dt instead of the wall clock, so captures are
+// reproducible and run as fast as the GPU allows.
+void runOffscreenFrame(GameContext &ctx, double frame_dt);
+void finishOffscreen(GameContext &ctx);
+
+void handleKeys(GLFWwindow* window, int key, int code, int action, int mode);
+
+#endif
\ No newline at end of file
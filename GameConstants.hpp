@@ -0,0 +1,40 @@
+#ifndef GAME_CONSTANTS_HPP
+#define GAME_CONSTANTS_HPP
+
+namespace GameConstants {
+
+    constexpr float BALL_SPEED_INITIAL = 1.5f;
+
+    constexpr float BALL_SPEED_REFLECT_PLAYER_1 = 2.5f;
+    constexpr float BALL_SPEED_REFLECT_PLAYER_2 = BALL_SPEED_REFLECT_PLAYER_1;
+    
+    constexpr float PLAYER_1_SPEED = 2.5f;
+    constexpr float PLAYER_2_SPEED = PLAYER_1_SPEED;
+
+    constexpr float BALL_POS_INITIAL[2] = { 0.0f, 0.5f };
+
+    constexpr float PLAYER_1_POS_INITIAL[2] = { -1.5f, 0.5f };
+    constexpr float PLAYER_2_POS_INITIAL[2] = { 1.5f, 0.5f };
+
+    constexpr float PLAYER_1_WIDTH = 0.1f;
+    constexpr float PLAYER_1_HEIGHT = 0.5f;
+
+    constexpr float PLAYER_2_WIDTH = PLAYER_1_WIDTH;
+    constexpr float PLAYER_2_HEIGHT = PLAYER_1_HEIGHT;
+
+    constexpr float LINES_WIDTH = 0.05f;
+    constexpr float LINES_HEIGHT = 0.2f;
+    constexpr int NUM_LINES = 20;
+
+    constexpr float BALL_WIDTH = 0.1f;
+    constexpr float BALL_HEIGHT = 0.1f;
+
+    constexpr int WAIT_SECONDS_BEFORE_BALL_SPAWNS = 1;
+
+    constexpr int ATTRACT_AFTER_SECONDS = 30;
+
+    constexpr int SIM_TICK_RATE = 240;
+    constexpr int SIM_MAX_SUBSTEPS = 16;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "InputQueue.hpp"
+#include <chrono>
+
+bool InputQueue::push(const InputEvent &event)
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t next = (t + 1) % CAPACITY;
+
+    if (next == head.load(std::memory_order_acquire)) return false;
+
+    events[t] = event;
+    tail.store(next, std::memory_order_release);
+    return true;
+}
+
+bool InputQueue::peek(InputEvent &event) const
+{
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) return false;
+
+    event = events[h];
+    return true;
+}
+
+void InputQueue::pop()
+{
+    size_t h = head.load(std::memory_order_relaxed);
+    head.store((h + 1) % CAPACITY, std::memory_order_release);
+}
+
+uint64_t InputQueue::nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
\ No newline at end of file
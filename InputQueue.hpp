@@ -0,0 +1,46 @@
+#ifndef INPUT_QUEUE_HPP
+#define INPUT_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct InputEvent
+{
+    uint64_t time_ns = 0;
+    int32_t key = 0;
+    int32_t action = 0;
+};
+
+// Single-producer/single-consumer lock-free ring of timestamped key events.
+// The window callback pushes, the simulation drains events tick by tick so
+// each one lands on the tick during which it happened.
+class InputQueue
+{
+public:
+    static constexpr size_t CAPACITY = 256;
+
+    // Returns false (and drops the event) when the ring is full.
+    bool push(const InputEvent &event);
+
+    bool peek(InputEvent &event) const;
+    void pop();
+
+    // Monotonic clock shared by event timestamps and the simulation.
+    static uint64_t nowNs();
+
+private:
+    InputEvent events[CAPACITY];
+    alignas(64) std::atomic<size_t> head { 0 };
+    alignas(64) std::atomic<size_t> tail { 0 };
+};
+
+struct InputLatencyStats
+{
+    uint64_t samples = 0;
+    double total_ms = 0.0;
+    double max_ms = 0.0;
+    double last_ms = 0.0;
+};
+
+#endif
\ No newline at end of file
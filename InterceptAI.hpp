@@ -0,0 +1,145 @@
+#ifndef INTERCEPT_AI_HPP
+#define INTERCEPT_AI_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "PaddleKernel.hpp"
+
+// Paddle AI that works out where the ball will cross its paddle face in
+// closed form: the straight-line height at the face is folded back into the
+// field by the wall reflections, so a decision is O(1) however many bounces
+// are ahead. Decisions depend only on the current state and a seed, so the
+// same code drives Simulation matches, BatchSimulator lanes and replays.
+
+struct InterceptAIConfig
+{
+    // seconds after the ball leaves the far paddle before the AI commits;
+    // until then it holds still
+    float reaction_delay = 0.12f;
+
+    // largest aim miss as a fraction of the paddle height, redrawn on every
+    // approach; past 0.5 the AI starts letting balls through
+    float aim_error = 0.6f;
+
+    float dead_zone = 0.02f;
+};
+
+// What one paddle's AI looks at.
+struct InterceptView
+{
+    float ball_x;
+    float ball_y;
+    float ball_vx;
+    float ball_vy;
+
+    float paddle_y;
+    float paddle_height;
+
+    // ball centre x on touching this paddle and the opposite one
+    float face_x;
+    float far_face_x;
+
+    // range of the ball centre between the walls
+    float wall_down;
+    float wall_up;
+
+    // direction the ball travels to reach this paddle
+    float dir;
+};
+
+namespace InterceptAI {
+
+    // Ball centre height when it reaches face_x. Unfolded, the ball moves in
+    // a straight line; every wall bounce mirrors it, so the path repeats with
+    // period 2 * span and the second half runs backwards.
+    inline float predictY(const InterceptView &view)
+    {
+        float t = (view.face_x - view.ball_x) / view.ball_vx;
+        float y = view.ball_y + view.ball_vy * t - view.wall_down;
+
+        float span = view.wall_up - view.wall_down;
+        float period = 2.0f * span;
+
+        float u = y - period * std::floor(y / period);
+        if (u > span) u = period - u;
+
+        return view.wall_down + u;
+    }
+
+    inline int8_t decide(const InterceptView &view, const InterceptAIConfig &config, uint64_t seed)
+    {
+        float target = view.paddle_y;
+
+        if (view.ball_vx * view.dir > 0.0f) {
+            // x is linear between paddle hits, so the time since the far
+            // paddle sent the ball back follows from where it is now
+            float since = (view.ball_x - view.far_face_x) / view.ball_vx;
+
+            if (since >= config.reaction_delay) {
+                // the miss only changes when the ball's velocity does
+                uint32_t vx_bits, vy_bits;
+                std::memcpy(&vx_bits, &view.ball_vx, sizeof(vx_bits));
+                std::memcpy(&vy_bits, &view.ball_vy, sizeof(vy_bits));
+
+                uint64_t h = seed ^ ((uint64_t)vx_bits << 32 | vy_bits);
+                h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+                h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+                h ^= h >> 31;
+
+                float error = (float)(h >> 40) / (float)(1u << 24) * 2.0f - 1.0f;
+
+                target = predictY(view) + error * config.aim_error * view.paddle_height;
+            }
+        } else {
+            // drift back to the middle while the ball heads away
+            target = (view.wall_up + view.wall_down) * 0.5f;
+        }
+
+        if (target > view.paddle_y + config.dead_zone) return 1;
+        if (target < view.paddle_y - config.dead_zone) return -1;
+        return 0;
+    }
+
+    template <PaddleSide SIDE>
+    InterceptView makeView(const SimState &state, const MatchParams &params)
+    {
+        constexpr PaddleSide FAR_SIDE = SIDE == PaddleSide::Player_1 ? PaddleSide::Player_2 : PaddleSide::Player_1;
+        using Near = PaddleKernel<SIDE>;
+        using Far = PaddleKernel<FAR_SIDE>;
+
+        InterceptView view;
+        view.ball_x = state.ball.position.x;
+        view.ball_y = state.ball.position.y;
+        view.ball_vx = state.ball.speed.x;
+        view.ball_vy = state.ball.speed.y;
+        view.paddle_y = Near::paddle(state).position.y;
+        view.paddle_height = Near::paddle(state).height;
+        view.face_x = Near::faceX(state, Near::params(params));
+        view.far_face_x = Far::faceX(state, Far::params(params));
+        view.wall_down = state.config.bound_down + state.ball.height * 0.5f;
+        view.wall_up = state.config.bound_up - state.ball.height * 0.5f;
+        view.dir = Near::DIR;
+        return view;
+    }
+
+    // The miss is also re-rolled every 512 ticks (about 2 s), so a rally
+    // that happens to repeat itself exactly can't go on forever.
+    inline uint64_t tickSeed(uint64_t seed, uint64_t tick)
+    {
+        return seed + (tick >> 9) * 0x9E3779B97F4A7C15ull;
+    }
+
+    inline SimInputs decideBoth(const SimState &state, const InterceptAIConfig &config, uint64_t seed)
+    {
+        const MatchParams params = PaddleKernels::makeMatchParams(state.config);
+        seed = tickSeed(seed, state.tick);
+
+        SimInputs inputs;
+        inputs.p1_dir = decide(makeView<PaddleSide::Player_1>(state, params), config, seed);
+        inputs.p2_dir = decide(makeView<PaddleSide::Player_2>(state, params), config, ~seed);
+        return inputs;
+    }
+};
+
+#endif
\ No newline at end of file
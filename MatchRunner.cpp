@@ -0,0 +1,261 @@
+#include "MatchRunner.hpp"
+#include <chrono>
+#include <cstring>
+#include "InterceptAI.hpp"
+#include "Replay.hpp"
+
+namespace {
+
+    constexpr uint32_t CHUNK_SIZE = 4;
+
+    inline uint64_t packRange(uint32_t begin, uint32_t end)
+    {
+        return (uint64_t)begin | ((uint64_t)end << 32);
+    }
+
+    inline uint32_t rangeBegin(uint64_t range) { return (uint32_t)range; }
+    inline uint32_t rangeEnd(uint64_t range) { return (uint32_t)(range >> 32); }
+
+    inline uint32_t floatBits(float f)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        return bits;
+    }
+
+    int8_t chase(float paddle_y, float target_y)
+    {
+        constexpr float dead_zone = 0.02f;
+
+        if (target_y > paddle_y + dead_zone) return 1;
+        if (target_y < paddle_y - dead_zone) return -1;
+        return 0;
+    }
+}
+
+uint64_t MatchControllers::nextRandom(uint64_t &rng)
+{
+    // splitmix64
+    uint64_t z = (rng += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+SimInputs MatchControllers::trackBall(const SimState &state, uint64_t &rng)
+{
+    // The aim error only changes when the ball's velocity does (i.e. on a hit),
+    // so the paddle commits to one target per approach instead of jittering.
+    uint64_t h = rng ^ ((uint64_t)floatBits(state.ball.speed.x) << 32 | floatBits(state.ball.speed.y));
+    float error = (float)(nextRandom(h) >> 40) / (float)(1u << 24) - 0.5f;
+
+    SimInputs inputs;
+
+    if (state.ball.speed.x < 0.0f) {
+        inputs.p1_dir = chase(state.p1.position.y, state.ball.position.y + error * state.p1.height * 1.5f);
+        inputs.p2_dir = chase(state.p2.position.y, 0.0f);
+    } else {
+        inputs.p1_dir = chase(state.p1.position.y, 0.0f);
+        inputs.p2_dir = chase(state.p2.position.y, state.ball.position.y + error * state.p2.height * 1.5f);
+    }
+
+    return inputs;
+}
+
+SimInputs MatchControllers::interceptBall(const SimState &state, uint64_t &rng)
+{
+    return InterceptAI::decideBoth(state, InterceptAIConfig(), rng);
+}
+
+MatchResult playMatch(const MatchSpec &spec, MatchController controller, float dt, ReplayRecorder *recorder)
+{
+    SimState state;
+    Simulation::init(state, spec.config);
+
+    if (recorder) recorder->begin(spec.config, spec.seed, (int)(1.0f / dt + 0.5f));
+
+    uint64_t rng = spec.seed;
+    uint64_t rally_start = 0;
+
+    MatchResult result;
+
+    while (state.tick < spec.max_ticks && state.score_player_1 < spec.target_score && state.score_player_2 < spec.target_score) {
+        SimInputs inputs = controller(state, rng);
+        if (recorder) recorder->record(inputs);
+
+        uint32_t events = Simulation::step(state, inputs, dt);
+
+        if (events & SIM_EVENT_HIT_PLAYER_1) result.hits_player_1++;
+        if (events & SIM_EVENT_HIT_PLAYER_2) result.hits_player_2++;
+
+        if (events & (SIM_EVENT_PASSED_PLAYER_1 | SIM_EVENT_PASSED_PLAYER_2)) {
+            uint32_t rally_ticks = (uint32_t)(state.tick - rally_start);
+            result.rallies++;
+            result.total_rally_ticks += rally_ticks;
+            if (rally_ticks > result.longest_rally_ticks) result.longest_rally_ticks = rally_ticks;
+        }
+
+        if (events & SIM_EVENT_SERVE) rally_start = state.tick;
+    }
+
+    result.score_player_1 = state.score_player_1;
+    result.score_player_2 = state.score_player_2;
+    result.ticks = state.tick;
+
+    if (recorder) recorder->finish(state);
+
+    return result;
+}
+
+MatchRunner::MatchRunner(unsigned num_threads)
+{
+    if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 1;
+
+    ranges = std::vector<WorkerRange>(num_threads);
+
+    for (unsigned i = 0; i < num_threads; i++) {
+        workers.emplace_back(&MatchRunner::workerLoop, this, i);
+    }
+}
+
+MatchRunner::~MatchRunner()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    start_cv.notify_all();
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void MatchRunner::setController(MatchController c)
+{
+    controller = c;
+}
+
+void MatchRunner::setTickDt(float dt)
+{
+    tick_dt = dt;
+}
+
+RunnerStats MatchRunner::run(const std::vector<MatchSpec> &specs, std::vector<MatchResult> &results)
+{
+    RunnerStats stats;
+    stats.matches = specs.size();
+
+    results.assign(specs.size(), MatchResult());
+    if (specs.empty()) return stats;
+
+    auto start = std::chrono::steady_clock::now();
+
+    unsigned num_workers = (unsigned)ranges.size();
+    uint32_t count = (uint32_t)specs.size();
+
+    for (unsigned i = 0; i < num_workers; i++) {
+        uint32_t begin = (uint32_t)((uint64_t)count * i / num_workers);
+        uint32_t end = (uint32_t)((uint64_t)count * (i + 1) / num_workers);
+        ranges[i].range.store(packRange(begin, end), std::memory_order_relaxed);
+        ranges[i].ticks.store(0, std::memory_order_relaxed);
+        ranges[i].steals.store(0, std::memory_order_relaxed);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        job_specs = specs.data();
+        job_results = results.data();
+        active = num_workers;
+        generation++;
+        start_cv.notify_all();
+
+        done_cv.wait(lock, [this] { return active == 0; });
+    }
+
+    for (WorkerRange &r : ranges) {
+        stats.ticks += r.ticks.load(std::memory_order_relaxed);
+        stats.steals += r.steals.load(std::memory_order_relaxed);
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+bool MatchRunner::takeOwn(unsigned index, uint32_t &begin, uint32_t &end)
+{
+    std::atomic<uint64_t> &range = ranges[index].range;
+    uint64_t current = range.load(std::memory_order_acquire);
+
+    for (;;) {
+        uint32_t b = rangeBegin(current);
+        uint32_t e = rangeEnd(current);
+        if (b >= e) return false;
+
+        uint32_t nb = e - b > CHUNK_SIZE ? b + CHUNK_SIZE : e;
+        if (range.compare_exchange_weak(current, packRange(nb, e), std::memory_order_acq_rel)) {
+            begin = b;
+            end = nb;
+            return true;
+        }
+    }
+}
+
+bool MatchRunner::steal(unsigned index)
+{
+    unsigned num_workers = (unsigned)ranges.size();
+
+    for (unsigned offset = 1; offset < num_workers; offset++) {
+        std::atomic<uint64_t> &victim = ranges[(index + offset) % num_workers].range;
+        uint64_t current = victim.load(std::memory_order_acquire);
+
+        for (;;) {
+            uint32_t b = rangeBegin(current);
+            uint32_t e = rangeEnd(current);
+            if (b >= e) break;
+
+            uint32_t half = (e - b + 1) / 2;
+            if (victim.compare_exchange_weak(current, packRange(b, e - half), std::memory_order_acq_rel)) {
+                ranges[index].range.store(packRange(e - half, e), std::memory_order_release);
+                ranges[index].steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void MatchRunner::workerLoop(unsigned index)
+{
+    uint64_t seen_generation = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cv.wait(lock, [&] { return quit || generation != seen_generation; });
+            if (quit) return;
+            seen_generation = generation;
+        }
+
+        uint64_t ticks = 0;
+        uint32_t begin = 0, end = 0;
+
+        do {
+            while (takeOwn(index, begin, end)) {
+                for (uint32_t i = begin; i < end; i++) {
+                    job_results[i] = playMatch(job_specs[i], controller, tick_dt);
+                    ticks += job_results[i].ticks;
+                }
+            }
+        } while (steal(index));
+
+        ranges[index].ticks.store(ticks, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0) done_cv.notify_one();
+        }
+    }
+}
\ No newline at end of file
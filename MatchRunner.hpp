@@ -0,0 +1,114 @@
+#ifndef MATCH_RUNNER_HPP
+#define MATCH_RUNNER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Simulation.hpp"
+
+struct MatchSpec
+{
+    SimConfig config = Simulation::headlessConfig();
+    uint64_t seed = 1;
+    uint32_t target_score = 11;
+    uint32_t max_ticks = 240 * 60 * 10;
+};
+
+struct MatchResult
+{
+    uint32_t score_player_1 = 0;
+    uint32_t score_player_2 = 0;
+
+    uint32_t hits_player_1 = 0;
+    uint32_t hits_player_2 = 0;
+
+    uint32_t rallies = 0;
+    uint32_t longest_rally_ticks = 0;
+    uint64_t total_rally_ticks = 0;
+
+    uint64_t ticks = 0;
+};
+
+struct RunnerStats
+{
+    size_t matches = 0;
+    uint64_t ticks = 0;
+    double seconds = 0.0;
+    uint64_t steals = 0;
+};
+
+// Picks paddle inputs for one tick. rng is the match's private random state.
+using MatchController = SimInputs (*)(const SimState &state, uint64_t &rng);
+
+namespace MatchControllers {
+
+    uint64_t nextRandom(uint64_t &rng);
+
+    // Both paddles chase the ball with a small random aim error.
+    SimInputs trackBall(const SimState &state, uint64_t &rng);
+
+    // Both paddles move to the predicted intercept (InterceptAI) with the
+    // default reaction delay and aim error.
+    SimInputs interceptBall(const SimState &state, uint64_t &rng);
+};
+
+class ReplayRecorder;
+
+// Plays one match to target_score or max_ticks. With a recorder, the match is
+// also captured as a replay.
+MatchResult playMatch(const MatchSpec &spec, MatchController controller, float dt, ReplayRecorder *recorder = nullptr);
+
+// Persistent thread pool that plays batches of headless matches. Each worker
+// owns a range of match indices and takes small chunks off its front; idle
+// workers steal the back half of a victim's range. Ranges are single atomic
+// words, so the hot path never takes a lock and results are written straight
+// into their slot.
+class MatchRunner
+{
+public:
+    explicit MatchRunner(unsigned num_threads = 0);
+    ~MatchRunner();
+
+    MatchRunner(const MatchRunner &) = delete;
+    MatchRunner& operator=(const MatchRunner &) = delete;
+
+    void setController(MatchController controller);
+    void setTickDt(float dt);
+    unsigned getThreadCount() const { return (unsigned)workers.size(); }
+
+    RunnerStats run(const std::vector<MatchSpec> &specs, std::vector<MatchResult> &results);
+
+private:
+    struct alignas(64) WorkerRange
+    {
+        // low 32 bits: next match index, high 32 bits: end index
+        std::atomic<uint64_t> range { 0 };
+        std::atomic<uint64_t> ticks { 0 };
+        std::atomic<uint64_t> steals { 0 };
+    };
+
+    void workerLoop(unsigned index);
+    bool takeOwn(unsigned index, uint32_t &begin, uint32_t &end);
+    bool steal(unsigned index);
+
+    std::vector<std::thread> workers;
+    std::vector<WorkerRange> ranges;
+
+    MatchController controller = MatchControllers::trackBall;
+    float tick_dt = 1.0f / GameConstants::SIM_TICK_RATE;
+
+    const MatchSpec *job_specs = nullptr;
+    MatchResult *job_results = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    uint64_t generation = 0;
+    unsigned active = 0;
+    bool quit = false;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "MatchWall.hpp"
+#include <algorithm>
+#include <cmath>
+#include "GLState.hpp"
+
+MatchWall::MatchWall() : sim(0)
+{
+
+}
+
+void MatchWall::init(size_t num_matches, ShaderHandler &shader_handler, uint64_t seed)
+{
+    sim = BatchSimulator(num_matches);
+
+    // every match gets its own seed inside setAI, so the tiles soon drift apart
+    sim.setAI(true, InterceptAIConfig(), seed);
+
+    layoutTiles();
+
+    if (!id_tiles) glGenBuffers(1, &id_tiles);
+    if (!id_tile_texture) glGenTextures(1, &id_tile_texture);
+
+    GLState::bindBuffer(GL_TEXTURE_BUFFER, id_tiles);
+    glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)(tiles.size() * sizeof(GLfloat)), tiles.data(), GL_STATIC_DRAW);
+    GLState::bindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    GLState::bindTexture(TILE_TEXTURE_UNIT, GL_TEXTURE_BUFFER, id_tile_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, id_tiles);
+
+    rects_per_match_location = shader_handler.getUniformVariableId("rects_per_match");
+    tiles_location = shader_handler.getUniformVariableId("tiles");
+}
+
+void MatchWall::destroy()
+{
+    if (id_tile_texture) glDeleteTextures(1, &id_tile_texture);
+    if (id_tiles) glDeleteBuffers(1, &id_tiles);
+    id_tile_texture = 0;
+    id_tiles = 0;
+
+    GLState::invalidate();
+}
+
+void MatchWall::layoutTiles()
+{
+    const SimConfig &config = sim.getConfig();
+    size_t n = std::max<size_t>(sim.size(), 1);
+
+    // as square a grid as possible; the field keeps its shape in every tile,
+    // so the tile size is set by whichever of the two counts is larger
+    columns = (int)std::ceil(std::sqrt((double)n));
+    rows = (int)((n + columns - 1) / columns);
+
+    float field_width = config.bound_right - config.bound_left;
+    float field_height = config.bound_up - config.bound_down;
+    float cell_width = field_width / (float)columns;
+    float cell_height = field_height / (float)rows;
+
+    // leave a gap between neighbouring fields
+    float scale = 0.9f * std::min(cell_width / field_width, cell_height / field_height);
+
+    tiles.resize(sim.size() * 4);
+
+    for (size_t i = 0; i < sim.size(); i++) {
+        int col = (int)(i % (size_t)columns);
+        int row = (int)(i / (size_t)columns);
+
+        tiles[i * 4 + 0] = config.bound_left + ((float)col + 0.5f) * cell_width;
+        tiles[i * 4 + 1] = config.bound_up - ((float)row + 0.5f) * cell_height;
+        tiles[i * 4 + 2] = scale;
+        tiles[i * 4 + 3] = scale;
+    }
+}
+
+void MatchWall::step(float dt)
+{
+    sim.step(dt);
+}
+
+void MatchWall::draw(RectangleRenderer &renderer, ShaderHandler &shader_handler)
+{
+    using namespace GameConstants;
+
+    const SimConfig &config = sim.getConfig();
+    float field_height = config.bound_up - config.bound_down;
+
+    renderer.begin();
+
+    // balls are drawn at their latest tick, like in stress mode
+    for (size_t i = 0; i < sim.size(); i++) {
+        SimVec2 ball = sim.getBallPosition(i);
+
+        renderer.add(PLAYER_1_POS_INITIAL[0], sim.getPaddleY_player_1(i), config.player_1_width, config.player_1_height);
+        renderer.add(PLAYER_2_POS_INITIAL[0], sim.getPaddleY_player_2(i), config.player_2_width, config.player_2_height);
+        renderer.add(ball.x, ball.y, config.ball_width, config.ball_height);
+        renderer.add(0.0f, 0.0f, LINES_WIDTH, field_height);
+    }
+
+    GLState::bindTexture(TILE_TEXTURE_UNIT, GL_TEXTURE_BUFFER, id_tile_texture);
+    shader_handler.setUniform(tiles_location, (GLint)TILE_TEXTURE_UNIT);
+    shader_handler.setUniform(rects_per_match_location, RECTS_PER_MATCH);
+
+    renderer.draw();
+
+    // the same program draws the normal game, which has no tiles
+    shader_handler.setUniform(rects_per_match_location, 0);
+}
\ No newline at end of file
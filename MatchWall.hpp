@@ -0,0 +1,51 @@
+#ifndef MATCH_WALL_HPP
+#define MATCH_WALL_HPP
+
+#include <cstddef>
+#include <vector>
+#include <GL/glew.h>
+#include "BatchSimulator.hpp"
+#include "RectangleRenderer.hpp"
+#include "Shader.hpp"
+
+// A grid of live AI matches drawn in one pass. The matches run in a
+// BatchSimulator; every match adds RECTS_PER_MATCH rectangles in field
+// coordinates, and the vertex shader moves each group of instances into its
+// tile using an (offset, scale) pair per match read from a texture buffer.
+// The tiles only change with the layout, so a frame streams the rectangles
+// and issues one instanced draw no matter how many matches there are.
+class MatchWall
+{
+public:
+    static constexpr int RECTS_PER_MATCH = 4;
+    static constexpr GLuint TILE_TEXTURE_UNIT = 0;
+
+    MatchWall();
+
+    // Needs the game shaders linked; the tiles are uploaded here.
+    void init(size_t num_matches, ShaderHandler &shader_handler, uint64_t seed = 1);
+    void destroy();
+
+    void step(float dt);
+    void draw(RectangleRenderer &renderer, ShaderHandler &shader_handler);
+
+    size_t size() const { return sim.size(); }
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    const BatchSimulator& getSimulator() const { return sim; }
+
+private:
+    void layoutTiles();
+
+    BatchSimulator sim;
+    int columns = 0;
+    int rows = 0;
+    std::vector<GLfloat> tiles;
+
+    GLuint id_tiles{};
+    GLuint id_tile_texture{};
+    GLint rects_per_match_location = -1;
+    GLint tiles_location = -1;
+};
+
+#endif
\ No newline at end of file
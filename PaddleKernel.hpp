@@ -0,0 +1,156 @@
+#ifndef PADDLE_KERNEL_HPP
+#define PADDLE_KERNEL_HPP
+
+#include <cmath>
+#include "Simulation.hpp"
+
+// Collision, reflection and scoring tests for one paddle, written once and
+// specialized per side at compile time. Everything that only depends on the
+// config is folded into PaddleParams up front, so a test is a handful of
+// multiplies and compares that compile to selects, and a bounce does a single
+// sin/cos. Results are bit for bit those of the old per-player functions.
+
+enum class PaddleSide
+{
+    Player_1,
+    Player_2
+};
+
+struct PaddleParams
+{
+    float half_width;
+    float half_height;
+    float half_ball_width;
+
+    // 2 * theta_max / height: degrees of bounce per unit off the paddle centre
+    float angle_scale;
+    float reflect_speed;
+
+    // how far behind the paddle centre the ball counts as past it, and the
+    // field bound it then has to leave through
+    float pass_offset;
+    float bound;
+};
+
+struct MatchParams
+{
+    PaddleParams p1;
+    PaddleParams p2;
+};
+
+namespace PaddleKernels {
+
+    constexpr float THETA_MAX = 75.0f;
+    constexpr float DEG_TO_RAD = 0.01745329251994329577f;
+    constexpr float BALL_PASS_THROUGH_LIM = 0.6f;
+
+    constexpr MatchParams makeMatchParams(const SimConfig &config)
+    {
+        MatchParams params {};
+
+        params.p1.half_width = config.player_1_width * 0.5f;
+        params.p1.half_height = config.player_1_height * 0.5f;
+        params.p1.half_ball_width = config.ball_width * 0.5f;
+        params.p1.angle_scale = 2 * THETA_MAX / config.player_1_height;
+        params.p1.reflect_speed = config.ball_speed_reflect_player_1;
+        params.p1.pass_offset = config.player_1_width * BALL_PASS_THROUGH_LIM;
+        params.p1.bound = config.bound_left;
+
+        params.p2.half_width = config.player_2_width * 0.5f;
+        params.p2.half_height = config.player_2_height * 0.5f;
+        params.p2.half_ball_width = config.ball_width * 0.5f;
+        params.p2.angle_scale = 2 * THETA_MAX / config.player_2_height;
+        params.p2.reflect_speed = config.ball_speed_reflect_player_2;
+        params.p2.pass_offset = config.player_2_width * BALL_PASS_THROUGH_LIM;
+        params.p2.bound = config.bound_right;
+
+        return params;
+    }
+
+    // the stock match, resolved entirely at compile time
+    constexpr MatchParams DEFAULT_MATCH_PARAMS = makeMatchParams(SimConfig());
+};
+
+template <PaddleSide SIDE>
+struct PaddleKernel
+{
+    // direction the ball travels to reach this paddle
+    static constexpr float DIR = SIDE == PaddleSide::Player_1 ? -1.0f : 1.0f;
+
+    static const PaddleParams& params(const MatchParams &match)
+    {
+        if constexpr (SIDE == PaddleSide::Player_1) return match.p1;
+        else return match.p2;
+    }
+
+    static const SimBody& paddle(const SimState &state)
+    {
+        if constexpr (SIDE == PaddleSide::Player_1) return state.p1;
+        else return state.p2;
+    }
+
+    // x of the ball centre when it touches the paddle face
+    static float faceX(const SimState &state, const PaddleParams &p)
+    {
+        return paddle(state).position.x - DIR * p.half_width - DIR * p.half_ball_width;
+    }
+
+    // Time until the ball centre crosses the face within the paddle's height,
+    // or -1 when that doesn't happen within max_t. Paddles only catch the
+    // ball during a rally and while it moves towards them.
+    static float sweep(const SimState &state, const PaddleParams &p, float max_t)
+    {
+        const SimBody &ball = state.ball;
+        const SimBody &pad = paddle(state);
+
+        float face_x = faceX(state, p);
+        float t = (face_x - ball.position.x) / ball.speed.x;
+        float y = ball.position.y + ball.speed.y * t;
+
+        bool hit = (state.phase == MatchPhase::Rally) &
+                   (ball.speed.x * DIR > 0.0f) &
+                   ((face_x - ball.position.x) * DIR >= 0.0f) &
+                   (t <= max_t) &
+                   (y >= pad.position.y - p.half_height) &
+                   (y <= pad.position.y + p.half_height);
+
+        return hit ? t : -1.0f;
+    }
+
+    // Snaps the ball onto the face and sends it back at an angle that grows
+    // with the distance from the paddle centre. Rotating (reflect_speed, 0)
+    // leaves one term per component, so only sin and cos of the angle remain.
+    static void bounce(SimState &state, const PaddleParams &p)
+    {
+        float d = state.ball.position.y - paddle(state).position.y;
+        float angle = p.angle_scale * d * PaddleKernels::DEG_TO_RAD;
+
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+
+        state.ball.position.x = faceX(state, p);
+        state.ball.speed = { -DIR * c * p.reflect_speed, s * p.reflect_speed };
+    }
+
+    // Both sides measure the pass line behind the paddle centre towards the
+    // left, as the game always has.
+    static bool passed(const SimState &state, const PaddleParams &p)
+    {
+        float line = paddle(state).position.x - p.pass_offset;
+
+        if constexpr (SIDE == PaddleSide::Player_1) return state.ball.position.x <= line;
+        else return state.ball.position.x >= line;
+    }
+
+    // The ball has fully left the field past this paddle.
+    static bool outOfBounds(const SimState &state, const PaddleParams &p)
+    {
+        if constexpr (SIDE == PaddleSide::Player_1) return state.ball.position.x + p.half_ball_width <= p.bound;
+        else return state.ball.position.x - p.half_ball_width >= p.bound;
+    }
+};
+
+using PaddleKernel_player_1 = PaddleKernel<PaddleSide::Player_1>;
+using PaddleKernel_player_2 = PaddleKernel<PaddleSide::Player_2>;
+
+#endif
\ No newline at end of file
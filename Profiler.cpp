@@ -0,0 +1,170 @@
+#include "Profiler.hpp"
+
+#if defined(SIMPLEPONG_PROFILER)
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <GL/glew.h>
+
+namespace {
+
+    constexpr size_t MAX_EVENTS = 1 << 16;
+    constexpr int FRAMES_IN_FLIGHT = 4;
+    constexpr int MAX_GPU_ZONES = 16;
+    constexpr uint64_t LATEST_ZONES_LOOKBACK = 256;
+
+    struct ProfileEvent
+    {
+        const char *name;
+        uint64_t start_ns;
+        uint64_t duration_ns;
+        bool gpu;
+    };
+
+    struct GpuFrame
+    {
+        GLuint queries[MAX_GPU_ZONES]{};
+        const char *names[MAX_GPU_ZONES]{};
+        uint64_t start_ns[MAX_GPU_ZONES]{};
+        int count = 0;
+    };
+
+    struct ProfilerState
+    {
+        std::vector<ProfileEvent> events = std::vector<ProfileEvent>(MAX_EVENTS);
+        uint64_t num_recorded = 0;
+
+        GpuFrame gpu_frames[FRAMES_IN_FLIGHT];
+        int gpu_frame = 0;
+        bool gpu_zone_open = false;
+        bool gpu_ready = false;
+
+        std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    };
+
+    ProfilerState state;
+
+    void pushEvent(const char *name, uint64_t start_ns, uint64_t duration_ns, bool gpu)
+    {
+        // ring buffer: the newest MAX_EVENTS events survive
+        state.events[state.num_recorded % MAX_EVENTS] = { name, start_ns, duration_ns, gpu };
+        state.num_recorded++;
+    }
+
+    void initGpuQueries()
+    {
+        for (GpuFrame &frame : state.gpu_frames) {
+            glGenQueries(MAX_GPU_ZONES, frame.queries);
+        }
+        state.gpu_ready = true;
+    }
+
+    void collectGpuFrame(GpuFrame &frame)
+    {
+        for (int i = 0; i < frame.count; i++) {
+            GLint available = 0;
+            glGetQueryObjectiv(frame.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+            pushEvent(frame.names[i], frame.start_ns[i], elapsed, true);
+        }
+
+        frame.count = 0;
+    }
+}
+
+uint64_t Profiler::nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - state.epoch).count();
+}
+
+void Profiler::recordZone(const char *name, uint64_t start_ns, uint64_t end_ns)
+{
+    pushEvent(name, start_ns, end_ns - start_ns, false);
+}
+
+int Profiler::beginGpuZone(const char *name, uint64_t start_ns)
+{
+    if (!state.gpu_ready) initGpuQueries();
+
+    GpuFrame &frame = state.gpu_frames[state.gpu_frame];
+    if (state.gpu_zone_open || frame.count >= MAX_GPU_ZONES) return -1;
+
+    int slot = frame.count++;
+    frame.names[slot] = name;
+    frame.start_ns[slot] = start_ns;
+
+    glBeginQuery(GL_TIME_ELAPSED, frame.queries[slot]);
+    state.gpu_zone_open = true;
+    return slot;
+}
+
+void Profiler::endGpuZone(int slot)
+{
+    if (slot < 0) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    state.gpu_zone_open = false;
+}
+
+void Profiler::endFrame()
+{
+    if (!state.gpu_ready) return;
+
+    // the oldest frame in flight is the one about to be reused
+    state.gpu_frame = (state.gpu_frame + 1) % FRAMES_IN_FLIGHT;
+    collectGpuFrame(state.gpu_frames[state.gpu_frame]);
+}
+
+int Profiler::getLatestZones(ProfileZoneTime *zones, int max_zones)
+{
+    uint64_t count = state.num_recorded < LATEST_ZONES_LOOKBACK ? state.num_recorded : LATEST_ZONES_LOOKBACK;
+    int found = 0;
+
+    for (uint64_t i = 0; i < count && found < max_zones; i++) {
+        const ProfileEvent &e = state.events[(state.num_recorded - 1 - i) % MAX_EVENTS];
+
+        bool seen = false;
+        for (int z = 0; z < found && !seen; z++) {
+            seen = zones[z].gpu == e.gpu && strcmp(zones[z].name, e.name) == 0;
+        }
+
+        if (!seen) zones[found++] = { e.name, (double)e.duration_ns / 1e6, e.gpu };
+    }
+
+    return found;
+}
+
+bool Profiler::writeChromeTrace(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        printf("Error opening '%s' for writing\n", path);
+        return false;
+    }
+
+    uint64_t count = state.num_recorded < MAX_EVENTS ? state.num_recorded : MAX_EVENTS;
+    uint64_t first = state.num_recorded - count;
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+    for (uint64_t i = first; i < state.num_recorded; i++) {
+        const ProfileEvent &e = state.events[i % MAX_EVENTS];
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                e.name, e.gpu ? 2 : 1, e.start_ns / 1000.0, e.duration_ns / 1000.0);
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    printf("Wrote %llu profiler events to '%s'\n", (unsigned long long)count, path);
+    return true;
+}
+
+#endif
\ No newline at end of file
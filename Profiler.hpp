@@ -0,0 +1,90 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+// Scoped CPU/GPU zone profiler with Chrome trace export (chrome://tracing,
+// ui.perfetto.dev). Build with SIMPLEPONG_PROFILER defined to enable it;
+// otherwise every macro and call below compiles to nothing.
+//
+//     PROFILE_ZONE("physics");              // CPU time of the enclosing scope
+//     PROFILE_GPU_ZONE("drawGameObjects");  // CPU time plus GL_TIME_ELAPSED
+//     PROFILE_FRAME();                      // once per frame, after swap
+//
+// GPU zones must not nest. Their results are read back a few frames later,
+// and only once the driver reports them available, so the profiler never stalls.
+// Zones are meant for the main (GL) thread.
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// The newest time recorded for one zone, e.g. for an on-screen overlay.
+struct ProfileZoneTime
+{
+    const char *name;
+    double ms;
+    bool gpu;
+};
+
+#if defined(SIMPLEPONG_PROFILER)
+
+#include <cstdint>
+
+namespace Profiler {
+
+    uint64_t nowNs();
+    void recordZone(const char *name, uint64_t start_ns, uint64_t end_ns);
+
+    int beginGpuZone(const char *name, uint64_t start_ns);
+    void endGpuZone(int slot);
+
+    void endFrame();
+
+    // Fills zones with the newest time of up to max_zones distinct zones,
+    // newest first, and returns how many were found.
+    int getLatestZones(ProfileZoneTime *zones, int max_zones);
+
+    // Writes everything still in the event ring as Chrome trace-event JSON.
+    bool writeChromeTrace(const char *path);
+};
+
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char *name) : name(name), start_ns(Profiler::nowNs()) {}
+    ~ProfileZone() { Profiler::recordZone(name, start_ns, Profiler::nowNs()); }
+
+private:
+    const char *name;
+    uint64_t start_ns;
+};
+
+class GpuProfileZone
+{
+public:
+    explicit GpuProfileZone(const char *name) : cpu_zone(name), slot(Profiler::beginGpuZone(name, Profiler::nowNs())) {}
+    ~GpuProfileZone() { Profiler::endGpuZone(slot); }
+
+private:
+    ProfileZone cpu_zone;
+    int slot;
+};
+
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_GPU_ZONE(name) GpuProfileZone PROFILE_CONCAT(profile_gpu_zone_, __LINE__)(name)
+#define PROFILE_FRAME() Profiler::endFrame()
+
+#else
+
+namespace Profiler {
+
+    inline void endFrame() {}
+    inline int getLatestZones(ProfileZoneTime *, int) { return 0; }
+    inline bool writeChromeTrace(const char *) { return false; }
+};
+
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_GPU_ZONE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "RectangleRenderer.hpp"
+
+RectangleRenderer::RectangleRenderer() : unit_quad(1.0f, 1.0f, { 0.0f, 0.0f })
+{
+
+}
+
+void RectangleRenderer::init()
+{
+    buffer_handler.generateBuffers();
+    const Rectangle2D shapes[] = { unit_quad };
+    buffer_handler.addShapes(shapes);
+    buffer_handler.loadDataToGPU();
+}
+
+void RectangleRenderer::begin()
+{
+    // keeps capacity, so steady-state frames don't allocate
+    instances.clear();
+    draw_calls = 0;
+}
+
+void RectangleRenderer::add(GLfloat x, GLfloat y, GLfloat width, GLfloat height)
+{
+    instances.push_back(x);
+    instances.push_back(y);
+    instances.push_back(width);
+    instances.push_back(height);
+}
+
+void RectangleRenderer::add(const Rectangle2D &rect)
+{
+    add(rect.position.x, rect.position.y, rect.width, rect.height);
+}
+
+void RectangleRenderer::draw()
+{
+    GLuint num_instances = getNumInstances();
+    if (num_instances == 0) return;
+
+    buffer_handler.loadInstanceData(instances.data(), (GLuint)instances.size());
+
+    buffer_handler.bindIndexBuffer();
+    glDrawElementsInstanced(GL_TRIANGLES, unit_quad.getNumIndices(), GL_UNSIGNED_INT, nullptr, num_instances);
+    draw_calls++;
+
+    buffer_handler.endFrame();
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef RECTANGLE_RENDERER_HPP
+#define RECTANGLE_RENDERER_HPP
+
+#include <vector>
+#include <GL/glew.h>
+#include "BufferHandler.hpp"
+#include "Shapes2D.hpp"
+
+// Draws any number of axis-aligned rectangles with a single instanced draw call.
+// Every rectangle shares one unit quad; its centre and size go in the instance
+// buffer as (x, y, width, height).
+class RectangleRenderer
+{
+public:
+    RectangleRenderer();
+
+    void init();
+
+    void begin();
+    void add(GLfloat x, GLfloat y, GLfloat width, GLfloat height);
+    void add(const Rectangle2D &rect);
+    void draw();
+
+    GLuint getNumInstances() const { return (GLuint)(instances.size() / 4); }
+    GLuint getDrawCalls() const { return draw_calls; }
+    const StreamingStats& getLastFrameStreamingStats() const { return buffer_handler.getLastFrameStreamingStats(); }
+
+private:
+    BufferHandler buffer_handler;
+    Rectangle2D unit_quad;
+    std::vector<GLfloat> instances;
+    GLuint draw_calls = 0;
+};
+
+#endif
\ No newline at end of file
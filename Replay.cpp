@@ -0,0 +1,279 @@
+#include "Replay.hpp"
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    inline uint8_t packInputs(const SimInputs &inputs)
+    {
+        return (uint8_t)((inputs.p1_dir + 1) | ((inputs.p2_dir + 1) << 2));
+    }
+
+    inline bool unpackInputs(uint8_t packed, SimInputs &inputs)
+    {
+        int p1 = packed & 3;
+        int p2 = (packed >> 2) & 3;
+        if (p1 > 2 || p2 > 2 || (packed >> 4)) return false;
+
+        inputs.p1_dir = (int8_t)(p1 - 1);
+        inputs.p2_dir = (int8_t)(p2 - 1);
+        return true;
+    }
+
+    void writeVarint(std::vector<uint8_t> &out, uint64_t value)
+    {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    bool readVarint(const uint8_t *&cursor, const uint8_t *end, uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+            uint8_t byte = *cursor++;
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+}
+
+void ReplayRecorder::begin(const SimConfig &config, uint64_t seed, int tick_rate)
+{
+    header = ReplayHeader();
+    std::memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+    header.version = REPLAY_VERSION;
+    header.tick_rate = (uint16_t)tick_rate;
+    header.seed = seed;
+    header.config = config;
+
+    stream.clear();
+    last_change_tick = 0;
+    recording = true;
+}
+
+void ReplayRecorder::record(const SimInputs &inputs)
+{
+    if (!recording) return;
+
+    uint64_t tick = header.num_ticks++;
+
+    if (tick == 0 || inputs.p1_dir != last_inputs.p1_dir || inputs.p2_dir != last_inputs.p2_dir) {
+        writeVarint(stream, tick - last_change_tick);
+        stream.push_back(packInputs(inputs));
+
+        last_inputs = inputs;
+        last_change_tick = tick;
+    }
+}
+
+void ReplayRecorder::finish(const SimState &state)
+{
+    header.final_hash = Simulation::hashState(state);
+    header.stream_size = (uint32_t)stream.size();
+    recording = false;
+}
+
+std::vector<uint8_t> ReplayRecorder::getData() const
+{
+    ReplayHeader h = header;
+    h.stream_size = (uint32_t)stream.size();
+
+    std::vector<uint8_t> data(sizeof(h) + stream.size());
+    std::memcpy(data.data(), &h, sizeof(h));
+    if (!stream.empty()) std::memcpy(data.data() + sizeof(h), stream.data(), stream.size());
+    return data;
+}
+
+bool ReplayRecorder::save(const char *path) const
+{
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        printf("Error opening replay '%s' for writing\n", path);
+        return false;
+    }
+
+    std::vector<uint8_t> data = getData();
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+
+    if (!ok) printf("Error writing replay '%s'\n", path);
+    return ok;
+}
+
+ReplayFile::~ReplayFile()
+{
+    close();
+}
+
+bool ReplayFile::open(const char *path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        printf("Error opening replay '%s'\n", path);
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (!mapping) {
+        printf("Error mapping replay '%s'\n", path);
+        CloseHandle(file);
+        return false;
+    }
+
+    data = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    size = (size_t)file_size.QuadPart;
+    file_handle = file;
+    mapping_handle = mapping;
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Error opening replay '%s'\n", path);
+        return false;
+    }
+
+    struct stat st;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+
+    if (mapped != MAP_FAILED) {
+        madvise(mapped, (size_t)st.st_size, MADV_SEQUENTIAL);
+        data = (const uint8_t *)mapped;
+        size = (size_t)st.st_size;
+    }
+#endif
+
+    if (!data) {
+        printf("Error mapping replay '%s'\n", path);
+        close();
+        return false;
+    }
+
+    if (!Replay::parse(data, size, view)) {
+        printf("'%s' is not a valid replay\n", path);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void ReplayFile::close()
+{
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mapping_handle) CloseHandle((HANDLE)mapping_handle);
+    if (file_handle) CloseHandle((HANDLE)file_handle);
+    file_handle = nullptr;
+    mapping_handle = nullptr;
+#else
+    if (data) munmap((void *)data, size);
+#endif
+
+    data = nullptr;
+    size = 0;
+    view = ReplayView();
+}
+
+void ReplayPlayer::begin(const ReplayView &v)
+{
+    cursor = v.stream;
+    end = v.stream + v.stream_size;
+
+    current = SimInputs();
+    tick = 0;
+    num_ticks = v.header.num_ticks;
+    next_change_tick = UINT64_MAX;
+    corrupt = false;
+
+    uint64_t delta;
+    if (cursor < end) {
+        if (readVarint(cursor, end, delta)) next_change_tick = delta;
+        else corrupt = true;
+    }
+}
+
+bool ReplayPlayer::readRecord()
+{
+    if (cursor >= end || !unpackInputs(*cursor++, current)) return false;
+
+    uint64_t delta;
+    if (cursor == end) {
+        next_change_tick = UINT64_MAX;
+        return true;
+    }
+    if (!readVarint(cursor, end, delta) || delta == 0) return false;
+
+    next_change_tick += delta;
+    return true;
+}
+
+bool ReplayPlayer::next(SimInputs &inputs)
+{
+    if (isFinished()) return false;
+
+    if (tick == next_change_tick && !readRecord()) {
+        corrupt = true;
+        return false;
+    }
+
+    tick++;
+    inputs = current;
+    return true;
+}
+
+bool Replay::parse(const uint8_t *data, size_t size, ReplayView &view)
+{
+    if (size < sizeof(ReplayHeader)) return false;
+
+    ReplayHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) != 0) return false;
+    if (header.version != REPLAY_VERSION || header.tick_rate == 0) return false;
+    if (header.stream_size > size - sizeof(header)) return false;
+
+    view.header = header;
+    view.stream = data + sizeof(header);
+    view.stream_size = header.stream_size;
+    return true;
+}
+
+bool Replay::simulate(const ReplayView &view, SimState &state)
+{
+    Simulation::init(state, view.header.config);
+
+    const float dt = 1.0f / view.header.tick_rate;
+
+    ReplayPlayer player;
+    player.begin(view);
+
+    SimInputs inputs;
+    while (player.next(inputs)) {
+        Simulation::step(state, inputs, dt);
+    }
+
+    return !player.isCorrupt() && state.tick == view.header.num_ticks && Simulation::hashState(state) == view.header.final_hash;
+}
\ No newline at end of file
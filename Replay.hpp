@@ -0,0 +1,140 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "Simulation.hpp"
+
+// Replay file: a fixed header followed by the input stream. The stream only
+// stores changes: each record is a LEB128 varint of ticks since the previous
+// change and one byte with both paddle directions (2 bits each). The first
+// record is always at tick 0. Little-endian only; bump REPLAY_VERSION
+// whenever SimConfig or the simulation's behaviour changes.
+
+constexpr char REPLAY_MAGIC[4] = { 'S', 'P', 'R', 'P' };
+constexpr uint16_t REPLAY_VERSION = 2;
+
+struct ReplayHeader
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t tick_rate;
+
+    uint64_t seed;
+    uint64_t num_ticks;
+
+    // Simulation::hashState of the final state, checked on playback.
+    uint64_t final_hash;
+
+    SimConfig config;
+    uint32_t stream_size;
+    uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable<ReplayHeader>::value, "replay headers are read and written with memcpy");
+static_assert(sizeof(ReplayHeader) == 104, "replay header layout is part of the file format");
+
+// A parsed replay, pointing into memory owned by someone else.
+struct ReplayView
+{
+    ReplayHeader header {};
+    const uint8_t *stream = nullptr;
+    size_t stream_size = 0;
+};
+
+// Builds a replay in memory while a match is played.
+class ReplayRecorder
+{
+public:
+    void begin(const SimConfig &config, uint64_t seed, int tick_rate);
+
+    // Call once per tick with the inputs passed to Simulation::step.
+    void record(const SimInputs &inputs);
+
+    // Stores the tick count and final state hash.
+    void finish(const SimState &state);
+
+    bool save(const char *path) const;
+
+    // Header plus stream, laid out exactly as on disk.
+    std::vector<uint8_t> getData() const;
+
+    bool isRecording() const { return recording; }
+    uint64_t getNumTicks() const { return header.num_ticks; }
+
+private:
+    ReplayHeader header {};
+    std::vector<uint8_t> stream;
+
+    SimInputs last_inputs;
+    uint64_t last_change_tick = 0;
+    bool recording = false;
+};
+
+// Read-only memory mapping of a replay file.
+class ReplayFile
+{
+public:
+    ReplayFile() = default;
+    ~ReplayFile();
+
+    ReplayFile(const ReplayFile &) = delete;
+    ReplayFile& operator=(const ReplayFile &) = delete;
+
+    bool open(const char *path);
+    void close();
+
+    const ReplayView& getView() const { return view; }
+
+private:
+    ReplayView view;
+
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#endif
+};
+
+// Walks a replay's input stream one tick at a time.
+class ReplayPlayer
+{
+public:
+    void begin(const ReplayView &view);
+
+    // Inputs for the next tick. Returns false once every tick has been played
+    // or the stream turns out to be corrupt.
+    bool next(SimInputs &inputs);
+
+    uint64_t getTick() const { return tick; }
+    bool isFinished() const { return tick >= num_ticks || corrupt; }
+    bool isCorrupt() const { return corrupt; }
+
+private:
+    bool readRecord();
+
+    const uint8_t *cursor = nullptr;
+    const uint8_t *end = nullptr;
+
+    SimInputs current;
+    uint64_t tick = 0;
+    uint64_t num_ticks = 0;
+    uint64_t next_change_tick = UINT64_MAX;
+    bool corrupt = false;
+};
+
+namespace Replay {
+
+    // Checks the header and splits a file image into header and stream.
+    bool parse(const uint8_t *data, size_t size, ReplayView &view);
+
+    // Re-simulates the whole replay without rendering. Returns true when the
+    // final state hash matches the recorded one.
+    bool simulate(const ReplayView &view, SimState &state);
+};
+
+#endif
\ No newline at end of file
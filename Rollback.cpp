@@ -0,0 +1,280 @@
+#include "Rollback.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// a direction outside -1..1 would drive the paddle faster than the game allows
+static bool validPacket(const RollbackPacket &packet)
+{
+    if (packet.count > RollbackPacket::MAX_INPUTS) return false;
+
+    for (int i = 0; i < packet.count; i++) {
+        if (packet.dirs[i] < -1 || packet.dirs[i] > 1) return false;
+    }
+
+    return true;
+}
+
+void LoopbackTransport::connect(LoopbackTransport &a, LoopbackTransport &b, uint32_t delay_ticks)
+{
+    a.peer = &b;
+    b.peer = &a;
+    a.delay = b.delay = delay_ticks;
+    a.now = b.now = 0;
+    a.inbox.clear();
+    b.inbox.clear();
+}
+
+void LoopbackTransport::send(const RollbackPacket &packet)
+{
+    if (!peer) return;
+
+    // due on the peer's clock; both sides tick in lockstep in tests
+    peer->inbox.push_back({ peer->now + delay, packet });
+}
+
+bool LoopbackTransport::receive(RollbackPacket &packet)
+{
+    if (inbox.empty() || inbox.front().due > now) return false;
+
+    packet = inbox.front().packet;
+    inbox.pop_front();
+    return true;
+}
+
+UdpTransport::~UdpTransport()
+{
+    close();
+}
+
+#ifndef _WIN32
+
+bool UdpTransport::open(uint16_t local_port, const char *remote_host, uint16_t remote_port)
+{
+    close();
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo *remote = nullptr;
+    if (getaddrinfo(remote_host, nullptr, &hints, &remote) != 0 || !remote) {
+        printf("Error resolving '%s'\n", remote_host);
+        return false;
+    }
+
+    sockaddr_in remote_in;
+    std::memcpy(&remote_in, remote->ai_addr, sizeof(remote_in));
+    remote_in.sin_port = htons(remote_port);
+    freeaddrinfo(remote);
+
+    static_assert(sizeof(remote_addr) >= sizeof(sockaddr_in), "remote_addr too small");
+    std::memcpy(remote_addr, &remote_in, sizeof(remote_in));
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        printf("Error creating UDP socket\n");
+        return false;
+    }
+
+    sockaddr_in local_in = {};
+    local_in.sin_family = AF_INET;
+    local_in.sin_addr.s_addr = htonl(INADDR_ANY);
+    local_in.sin_port = htons(local_port);
+
+    if (bind(fd, (const sockaddr *)&local_in, sizeof(local_in)) != 0) {
+        printf("Error binding UDP port %u\n", (unsigned)local_port);
+        close();
+        return false;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+void UdpTransport::close()
+{
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+void UdpTransport::send(const RollbackPacket &packet)
+{
+    if (fd < 0) return;
+
+    sendto(fd, &packet, sizeof(packet), 0, (const sockaddr *)remote_addr, sizeof(sockaddr_in));
+}
+
+bool UdpTransport::receive(RollbackPacket &packet)
+{
+    if (fd < 0) return false;
+
+    // anything that isn't exactly one packet is dropped
+    for (;;) {
+        ssize_t size = recv(fd, &packet, sizeof(packet), 0);
+        if (size < 0) return false;
+        if ((size_t)size == sizeof(packet) && validPacket(packet)) return true;
+    }
+}
+
+#else
+
+bool UdpTransport::open(uint16_t, const char *, uint16_t)
+{
+    printf("UDP versus play is only supported on POSIX systems\n");
+    return false;
+}
+
+void UdpTransport::close() {}
+void UdpTransport::send(const RollbackPacket &) {}
+bool UdpTransport::receive(RollbackPacket &) { return false; }
+
+#endif
+
+void RollbackSession::begin(const SimConfig &config, int player, RollbackTransport *t, float dt)
+{
+    Simulation::init(state, config);
+    snapshots.clear();
+
+    std::memset(local_dirs, 0, sizeof(local_dirs));
+    std::memset(remote_dirs, 0, sizeof(remote_dirs));
+
+    transport = t;
+    local_player = player;
+    tick_dt = dt;
+
+    confirmed_ticks = 0;
+    peer_ack = 0;
+    last_confirmed_remote = 0;
+    mispredicted_tick = UINT64_MAX;
+
+    stats = RollbackStats();
+}
+
+SimInputs RollbackSession::inputsFor(uint64_t tick) const
+{
+    SimInputs inputs;
+    int8_t local = local_dirs[tick % WINDOW];
+    int8_t remote = remote_dirs[tick % WINDOW];
+
+    inputs.p1_dir = local_player == 1 ? local : remote;
+    inputs.p2_dir = local_player == 1 ? remote : local;
+    return inputs;
+}
+
+void RollbackSession::receiveRemote()
+{
+    RollbackPacket packet;
+
+    while (transport->receive(packet)) {
+        // UdpTransport already drops these; other transports may not
+        if (!validPacket(packet)) continue;
+
+        // keep tick % WINDOW from aliasing a slot a pending resimulation or
+        // the ticks up to this one still need
+        uint64_t limit = std::min<uint64_t>(state.tick, mispredicted_tick) + WINDOW - 1;
+
+        peer_ack = std::max<uint64_t>(peer_ack, packet.ack);
+
+        for (int i = 0; i < packet.count; i++) {
+            uint64_t tick = (uint64_t)packet.first_tick + i;
+
+            // inputs arrive in order; older ones are duplicates, later ones wait for a resend
+            if (tick != confirmed_ticks || tick >= limit) continue;
+
+            int8_t dir = packet.dirs[i];
+            int8_t &slot = remote_dirs[tick % WINDOW];
+
+            if (tick < state.tick && slot != dir) {
+                mispredicted_tick = std::min(mispredicted_tick, tick);
+            }
+
+            slot = dir;
+            last_confirmed_remote = dir;
+            confirmed_ticks++;
+        }
+    }
+}
+
+void RollbackSession::sendLocal()
+{
+    RollbackPacket packet;
+    packet.ack = (uint32_t)confirmed_ticks;
+    packet.first_tick = (uint32_t)peer_ack;
+
+    uint64_t end = std::min<uint64_t>(state.tick, peer_ack + RollbackPacket::MAX_INPUTS);
+    for (uint64_t tick = peer_ack; tick < end; tick++) {
+        packet.dirs[packet.count++] = local_dirs[tick % WINDOW];
+    }
+
+    transport->send(packet);
+}
+
+uint32_t RollbackSession::stepTick()
+{
+    uint64_t tick = state.tick;
+
+    // unconfirmed ticks assume the remote paddle kept doing what it last did
+    if (tick >= confirmed_ticks) remote_dirs[tick % WINDOW] = last_confirmed_remote;
+
+    snapshots.save(state);
+    return Simulation::step(state, inputsFor(tick), tick_dt);
+}
+
+void RollbackSession::rollback()
+{
+    uint64_t target = mispredicted_tick;
+    mispredicted_tick = UINT64_MAX;
+
+    uint64_t present = state.tick;
+    if (target >= present) return;
+
+    if (!snapshots.restore(target, state)) {
+        // the stall rules keep this from happening
+        printf("Rollback to tick %llu failed, snapshot already overwritten\n", (unsigned long long)target);
+        return;
+    }
+
+    while (state.tick < present) {
+        stepTick();
+    }
+
+    uint32_t ticks = (uint32_t)(present - target);
+    stats.rollbacks++;
+    stats.resimulated_ticks += ticks;
+    stats.max_rollback_ticks = std::max(stats.max_rollback_ticks, ticks);
+}
+
+bool RollbackSession::advance(int8_t local_dir, uint32_t &events)
+{
+    events = SIM_EVENT_NONE;
+
+    transport->update();
+    receiveRemote();
+
+    if (mispredicted_tick != UINT64_MAX) rollback();
+
+    uint64_t tick = state.tick;
+
+    // don't outrun what can still be rolled back or resent
+    if (tick + 1 >= confirmed_ticks + WINDOW || tick + 1 >= peer_ack + WINDOW) {
+        stats.stalls++;
+        sendLocal();
+        return false;
+    }
+
+    local_dirs[tick % WINDOW] = local_dir;
+    events = stepTick();
+
+    sendLocal();
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+#ifndef ROLLBACK_HPP
+#define ROLLBACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include "Simulation.hpp"
+
+// Snapshots of the last N ticks, indexed by tick. Each slot holds the state
+// right before that tick was simulated.
+template <size_t N>
+class SnapshotRing
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "ring size must be a power of two");
+
+public:
+    SnapshotRing() { clear(); }
+
+    void clear()
+    {
+        for (SimSnapshot &slot : slots) slot.tick = UINT32_MAX;
+    }
+
+    void save(const SimState &state)
+    {
+        Simulation::saveSnapshot(state, slots[state.tick & (N - 1)]);
+    }
+
+    // Fails when the tick has already been overwritten or was never saved.
+    bool restore(uint64_t tick, SimState &state) const
+    {
+        const SimSnapshot &slot = slots[tick & (N - 1)];
+        if (slot.tick != (uint32_t)tick) return false;
+
+        Simulation::restoreSnapshot(state, slot);
+        return true;
+    }
+
+    static constexpr size_t size() { return N; }
+
+private:
+    SimSnapshot slots[N];
+};
+
+// One player's inputs for every tick the peer hasn't acknowledged yet. Each
+// packet resends all of them, so lost or reordered datagrams only delay the peer.
+struct RollbackPacket
+{
+    // RollbackSession never has more unacknowledged ticks than this
+    static constexpr int MAX_INPUTS = 64;
+
+    // the sender has the receiver's inputs for every tick below this
+    uint32_t ack = 0;
+    uint32_t first_tick = 0;
+    uint8_t count = 0;
+    int8_t dirs[MAX_INPUTS] = {};
+};
+
+class RollbackTransport
+{
+public:
+    virtual ~RollbackTransport() = default;
+
+    // Called once per simulated tick, before the packets are drained.
+    virtual void update() {}
+
+    virtual void send(const RollbackPacket &packet) = 0;
+    virtual bool receive(RollbackPacket &packet) = 0;
+};
+
+// In-process stand-in for a network link, with a fixed delay in ticks.
+class LoopbackTransport : public RollbackTransport
+{
+public:
+    static void connect(LoopbackTransport &a, LoopbackTransport &b, uint32_t delay_ticks);
+
+    void update() override { now++; }
+    void send(const RollbackPacket &packet) override;
+    bool receive(RollbackPacket &packet) override;
+
+private:
+    struct InFlight
+    {
+        uint64_t due = 0;
+        RollbackPacket packet;
+    };
+
+    LoopbackTransport *peer = nullptr;
+    uint32_t delay = 0;
+    uint64_t now = 0;
+    std::deque<InFlight> inbox;
+};
+
+// Non-blocking UDP socket. Only available on POSIX systems.
+class UdpTransport : public RollbackTransport
+{
+public:
+    ~UdpTransport() override;
+
+    bool open(uint16_t local_port, const char *remote_host, uint16_t remote_port);
+    void close();
+
+    void send(const RollbackPacket &packet) override;
+    bool receive(RollbackPacket &packet) override;
+
+private:
+    int fd = -1;
+    unsigned char remote_addr[16] = {};
+};
+
+struct RollbackStats
+{
+    uint64_t rollbacks = 0;
+    uint64_t resimulated_ticks = 0;
+    uint32_t max_rollback_ticks = 0;
+    uint64_t stalls = 0;
+};
+
+// Two-player versus play with rollback. Every tick the remote paddle is
+// predicted to keep its last confirmed direction. When the real input for
+// an earlier tick arrives and differs, the match is restored to the snapshot
+// before that tick and resimulated up to the present within the same call.
+class RollbackSession
+{
+public:
+    // Ticks that can be rolled back. The session stalls rather than run
+    // further ahead of the last confirmed remote input.
+    static constexpr size_t WINDOW = 64;
+    static_assert(WINDOW <= RollbackPacket::MAX_INPUTS, "a packet must hold every unacknowledged input");
+
+    void begin(const SimConfig &config, int local_player, RollbackTransport *transport, float dt);
+
+    // Exchanges inputs, fixes any misprediction and simulates one tick with
+    // local_dir. Returns false without stepping while waiting for the peer.
+    bool advance(int8_t local_dir, uint32_t &events);
+
+    const SimState& getState() const { return state; }
+    const RollbackStats& getStats() const { return stats; }
+    uint64_t getConfirmedTick() const { return confirmed_ticks; }
+
+private:
+    SimInputs inputsFor(uint64_t tick) const;
+
+    void receiveRemote();
+    void sendLocal();
+    void rollback();
+    uint32_t stepTick();
+
+    SimState state;
+    SnapshotRing<WINDOW> snapshots;
+
+    // indexed by tick % WINDOW; remote_dirs holds the confirmed input where
+    // known and the prediction that was simulated otherwise
+    int8_t local_dirs[WINDOW] = {};
+    int8_t remote_dirs[WINDOW] = {};
+
+    RollbackTransport *transport = nullptr;
+    int local_player = 1;
+    float tick_dt = 0.0f;
+
+    // remote inputs are known for every tick below confirmed_ticks, and the
+    // peer has ours for every tick below peer_ack
+    uint64_t confirmed_ticks = 0;
+    uint64_t peer_ack = 0;
+    int8_t last_confirmed_remote = 0;
+    uint64_t mispredicted_tick = UINT64_MAX;
+
+    RollbackStats stats;
+};
+
+#endif
\ No newline at end of file
@@ -1,26 +1,69 @@
 #include "Shader.hpp"
 #include <GL/glew.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <cstdio>
+#include <cstring>
+#include "GLState.hpp"
 
-static bool compileShader(Shader &shader)
-{
-    int id = shader.id;
-    GLenum type = shader.type;
-    std::string code = shader.code;
+namespace {
+
+    constexpr uint32_t CACHE_MAGIC = 0x43425053; // "SPBC"
+
+    struct CacheHeader
+    {
+        uint32_t magic = CACHE_MAGIC;
+        GLenum format = 0;
+        uint64_t key = 0;
+        uint32_t length = 0;
+        uint32_t reserved = 0;
+    };
+
+    void enableParallelCompile()
+    {
+        static bool enabled = false;
+        if (enabled) return;
+        enabled = true;
 
-    const GLchar* c_code = code.c_str();
-    GLint size = (GLint)code.size();
+        // let the driver pick how many threads to use
+        if (GLEW_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        else if (GLEW_ARB_parallel_shader_compile) glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
 
-    glShaderSource(id, 1, &c_code, &size);
-    glCompileShader(id);
+    uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return hash;
+    }
 
+    uint64_t fnv1a(uint64_t hash, const GLubyte *str)
+    {
+        const char *c_str = str ? (const char *)str : "";
+        return fnv1a(hash, c_str, strlen(c_str) + 1);
+    }
+}
+
+static void issueCompile(const Shader &shader)
+{
+    const GLchar* c_code = shader.code.c_str();
+    GLint size = (GLint)shader.code.size();
+
+    glShaderSource(shader.id, 1, &c_code, &size);
+    glCompileShader(shader.id);
+}
+
+static bool checkCompileStatus(const Shader &shader)
+{
     GLint result = 0;
     GLchar log[1024] = { 0 };
 
-    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+    glGetShaderiv(shader.id, GL_COMPILE_STATUS, &result);
 
     if (!result) {
-        glGetShaderInfoLog(id, sizeof(log), nullptr, log);
-        printf("Error compiling the %d shader: '%s'\n", type, log);
+        glGetShaderInfoLog(shader.id, sizeof(log), nullptr, log);
+        printf("Error compiling the %d shader: '%s'\n", shader.type, log);
         return false;
     }
 
@@ -40,10 +83,26 @@ void ShaderHandler::add(Shader& shader)
     shaders.push_back(shader);
 }
 
+void ShaderHandler::setBinaryCache(const std::string &path)
+{
+    cache_path = path;
+}
+
 void ShaderHandler::compileShaders()
 {
+    if (!cache_path.empty() && loadBinary()) {
+        compiled = true;
+        linked = true;
+        loaded_from_cache = true;
+        reflectUniforms();
+        return;
+    }
+
+    enableParallelCompile();
+
+    // statuses are only checked if the link fails, so nothing here waits on the compiler
     for (Shader& shader : shaders) {
-        compileShader(shader);
+        issueCompile(shader);
         glAttachShader(current_id, shader.id);
     }
 
@@ -52,26 +111,157 @@ void ShaderHandler::compileShaders()
 
 void ShaderHandler::linkShaders()
 {
-    if (!compiled) return;
+    if (!compiled || linked) return;
+
+    if (!cache_path.empty() && GLEW_ARB_get_program_binary) {
+        glProgramParameteri(current_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
 
     glLinkProgram(current_id);
+    link_pending = true;
+}
+
+bool ShaderHandler::finishLinking()
+{
+    if (!link_pending) return linked;
+    link_pending = false;
 
     GLint result = 0;
     GLchar log[1024] = { 0 };
 
     glGetProgramiv(current_id, GL_LINK_STATUS, &result);
     if (!result) {
+        printCompileErrors();
+
         glGetProgramInfoLog(current_id, sizeof(log), nullptr, log);
         printf("Error linking program: '%s'", log);
-        return;
+        return false;
     }
 
     linked = true;
+
+    reflectUniforms();
+
+    if (!cache_path.empty()) saveBinary();
+
+    return true;
+}
+
+void ShaderHandler::printCompileErrors()
+{
+    for (const Shader& shader : shaders) {
+        checkCompileStatus(shader);
+    }
+}
+
+uint64_t ShaderHandler::getCacheKey() const
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (const Shader& shader : shaders) {
+        hash = fnv1a(hash, &shader.type, sizeof(shader.type));
+        hash = fnv1a(hash, shader.code.data(), shader.code.size());
+    }
+
+    // binaries are only valid for the driver that produced them
+    hash = fnv1a(hash, glGetString(GL_VENDOR));
+    hash = fnv1a(hash, glGetString(GL_RENDERER));
+    hash = fnv1a(hash, glGetString(GL_VERSION));
+
+    return hash;
+}
+
+bool ShaderHandler::loadBinary()
+{
+    if (!GLEW_ARB_get_program_binary) return false;
+
+    FILE *file = fopen(cache_path.c_str(), "rb");
+    if (!file) return false;
+
+    CacheHeader header;
+    std::vector<unsigned char> binary;
+
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 && header.magic == CACHE_MAGIC && header.key == getCacheKey() && header.length > 0;
+    if (ok) {
+        binary.resize(header.length);
+        ok = fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+
+    if (!ok) return false;
+
+    glProgramBinary(current_id, header.format, binary.data(), (GLsizei)binary.size());
+
+    GLint result = 0;
+    glGetProgramiv(current_id, GL_LINK_STATUS, &result);
+    if (!result) {
+        printf("Shader cache '%s' was rejected by the driver, rebuilding it\n", cache_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void ShaderHandler::saveBinary()
+{
+    if (!GLEW_ARB_get_program_binary) return;
+
+    GLint length = 0;
+    glGetProgramiv(current_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    CacheHeader header;
+    header.key = getCacheKey();
+
+    std::vector<unsigned char> binary(length);
+    glGetProgramBinary(current_id, length, &length, &header.format, binary.data());
+    header.length = (uint32_t)length;
+
+    FILE *file = fopen(cache_path.c_str(), "wb");
+    if (!file) {
+        printf("Error opening shader cache '%s' for writing\n", cache_path.c_str());
+        return;
+    }
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(binary.data(), 1, header.length, file);
+    fclose(file);
+}
+
+void ShaderHandler::reflectUniforms()
+{
+    uniform_vars.clear();
+    uniform_values.clear();
+
+    GLint num_uniforms = 0;
+    glGetProgramiv(current_id, GL_ACTIVE_UNIFORMS, &num_uniforms);
+
+    for (GLint i = 0; i < num_uniforms; i++) {
+        GLchar name[256] = { 0 };
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+
+        glGetActiveUniform(current_id, (GLuint)i, sizeof(name), &length, &size, &type, name);
+
+        // uniforms inside blocks have no location
+        GLint location = glGetUniformLocation(current_id, name);
+        if (location < 0) continue;
+
+        std::string uniform_name(name, length);
+        uniform_vars[uniform_name] = location;
+
+        // arrays are reported as "name[0]", also make them reachable as "name"
+        size_t bracket = uniform_name.find('[');
+        if (bracket != std::string::npos) {
+            uniform_vars[uniform_name.substr(0, bracket)] = location;
+        }
+    }
 }
 
 void ShaderHandler::validateShaders()
 {
-    if (!linked) return;
+    if (!finishLinking()) return;
 
     glValidateProgram(current_id);
 
@@ -90,15 +280,79 @@ void ShaderHandler::validateShaders()
 
 GLint ShaderHandler::getUniformVariableId(const std::string& name)
 {
-    return glGetUniformLocation(current_id, name.c_str());
+    auto it = uniform_vars.find(name);
+    return it != uniform_vars.end() ? it->second : -1;
+}
+
+void ShaderHandler::bindUniformBlock(const std::string& block_name, GLuint binding)
+{
+    GLuint index = glGetUniformBlockIndex(current_id, block_name.c_str());
+    if (index == GL_INVALID_INDEX) {
+        printf("Uniform block '%s' not found\n", block_name.c_str());
+        return;
+    }
+
+    glUniformBlockBinding(current_id, index, binding);
+}
+
+bool ShaderHandler::isUnchanged(GLint location, const GLfloat* data, GLsizei size)
+{
+    UniformValue& cached = uniform_values[location];
+
+    if (cached.size == size && memcmp(cached.data, data, size * sizeof(GLfloat)) == 0) {
+        return true;
+    }
+
+    memcpy(cached.data, data, size * sizeof(GLfloat));
+    cached.size = size;
+    return false;
+}
+
+void ShaderHandler::setUniform(GLint location, GLint value)
+{
+    if (location < 0) return;
+
+    GLfloat bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (isUnchanged(location, &bits, 1)) return;
+
+    glUniform1i(location, value);
+}
+
+void ShaderHandler::setUniform(GLint location, GLfloat value)
+{
+    if (location < 0 || isUnchanged(location, &value, 1)) return;
+
+    glUniform1f(location, value);
+}
+
+void ShaderHandler::setUniform(GLint location, const glm::vec2& value)
+{
+    if (location < 0 || isUnchanged(location, glm::value_ptr(value), 2)) return;
+
+    glUniform2fv(location, 1, glm::value_ptr(value));
+}
+
+void ShaderHandler::setUniform(GLint location, const glm::vec4& value)
+{
+    if (location < 0 || isUnchanged(location, glm::value_ptr(value), 4)) return;
+
+    glUniform4fv(location, 1, glm::value_ptr(value));
+}
+
+void ShaderHandler::setUniform(GLint location, const glm::mat4& value)
+{
+    if (location < 0 || isUnchanged(location, glm::value_ptr(value), 16)) return;
+
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
 void ShaderHandler::enableShaders()
 {
-    glUseProgram(current_id);
+    GLState::useProgram(current_id);
 }
 
 void ShaderHandler::disableShaders()
 {
-    glUseProgram(0);
+    GLState::useProgram(0);
 }
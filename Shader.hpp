@@ -1,8 +1,10 @@
 #ifndef SHADER_HPP
 #define SHADER_HPP
 
+#include <cstdint>
 #include <string>
 #include <GL/glew.h>
+#include <glm/glm.hpp>
 #include <vector>
 #include <unordered_map>
 
@@ -19,19 +21,59 @@ public:
 	ShaderHandler();
 
 	void add(Shader& shader);
+
+	// Loads the linked program from this file when it was written for the same
+	// sources and driver; otherwise the program is built from source and the
+	// file is rewritten. Set before compileShaders.
+	void setBinaryCache(const std::string &path);
+
+	// Compiling and linking only issue the work. With KHR_parallel_shader_compile
+	// the driver builds the program in the background until the first status
+	// query, which validateShaders (or finishLinking) makes.
 	void compileShaders();
 	void linkShaders();
+	bool finishLinking();
 	void validateShaders();
+	bool isLoadedFromCache() const { return loaded_from_cache; }
+
 	GLint getUniformVariableId(const std::string &name);
+	void bindUniformBlock(const std::string &block_name, GLuint binding);
 	void enableShaders();
 	void disableShaders();
 
+	// The program must be enabled. Uploads are skipped when the value is unchanged.
+	void setUniform(GLint location, GLint value);
+	void setUniform(GLint location, GLfloat value);
+	void setUniform(GLint location, const glm::vec2 &value);
+	void setUniform(GLint location, const glm::vec4 &value);
+	void setUniform(GLint location, const glm::mat4 &value);
+
+	template <class T>
+	void setUniform(const std::string &name, const T &value) { setUniform(getUniformVariableId(name), value); }
+
 private:
+	struct UniformValue
+	{
+		GLfloat data[16]{};
+		GLsizei size = 0;
+	};
+
+	void reflectUniforms();
+	uint64_t getCacheKey() const;
+	bool loadBinary();
+	void saveBinary();
+	void printCompileErrors();
+	bool isUnchanged(GLint location, const GLfloat *data, GLsizei size);
 
 	std::unordered_map<std::string, int> uniform_vars;
+	std::unordered_map<GLint, UniformValue> uniform_values;
 	std::vector<Shader> shaders;
 	int current_id = 0;
 
+	std::string cache_path;
+	bool loaded_from_cache = false;
+	bool link_pending = false;
+
 	bool program_created = false;
 	bool compiled = false;
 	bool linked = false;
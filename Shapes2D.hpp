@@ -14,8 +14,8 @@ struct Rectangle2D
     GLfloat height = 0;
     GLfloat width = 0;
 
-    Point2D position { 0.0 };
-    Point2D speed { 0.0 };
+    Point2D position { 0.0f, 0.0f };
+    Point2D speed { 0.0f, 0.0f };
 
     GLfloat vertices[8] = {
         -0.5f, -0.5f,
@@ -29,15 +29,15 @@ struct Rectangle2D
         1, 2, 3
     };
 
-    int getNumVertices() { return 8; }
-    int getNumIndices() { return 6; }
+    int getNumVertices() const { return 8; }
+    int getNumIndices() const { return 6; }
 
-    int vertexBufferSize() { return getNumVertices() * sizeof(GLfloat); }
-    int indexBufferSize() { return getNumIndices() * sizeof(GLuint); }
+    int vertexBufferSize() const { return getNumVertices() * sizeof(GLfloat); }
+    int indexBufferSize() const { return getNumIndices() * sizeof(GLuint); }
 
     Rectangle2D() = default;
 
-    Rectangle2D(GLfloat width, GLfloat height, const Point2D &position) : width(width), height(height), position(position) {
+    Rectangle2D(GLfloat width, GLfloat height, const Point2D &position) : height(height), width(width), position(position) {
         for (int i = 0; i < getNumVertices(); i+=2) vertices[i] *= width;
         for (int i = 1; i < getNumVertices(); i+=2) vertices[i] *= height;
     }
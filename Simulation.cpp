@@ -0,0 +1,305 @@
+#include "Simulation.hpp"
+#include "PaddleKernel.hpp"
+#include <cmath>
+#include <cstddef>
+
+namespace {
+
+    enum Surface
+    {
+        SURFACE_NONE,
+        SURFACE_PLAYER_1,
+        SURFACE_PLAYER_2,
+        SURFACE_UP,
+        SURFACE_DOWN
+    };
+
+    struct Fnv1a
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+
+        void add(const void *data, size_t size)
+        {
+            const unsigned char *bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; i++) {
+                hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+            }
+        }
+
+        void add(const SimBody &body)
+        {
+            add(&body.position, sizeof(body.position));
+            add(&body.speed, sizeof(body.speed));
+        }
+    };
+}
+
+static void updatePosition(SimBody &obj, float dt)
+{
+    obj.position.x += obj.speed.x * dt;
+    obj.position.y += obj.speed.y * dt;
+}
+
+static float sweepWall(const SimBody &ball, float wall_y, float direction, float max_t)
+{
+    if (ball.speed.y * direction <= 0.0f) return -1.0f;
+
+    // a ball already past the wall bounces right away
+    float t = (wall_y - ball.position.y) / ball.speed.y;
+    if (t < 0.0f) t = 0.0f;
+
+    return t <= max_t ? t : -1.0f;
+}
+
+static float wallY_up(const SimState &state)
+{
+    return state.config.bound_up - state.ball.height * 0.5f;
+}
+
+static float wallY_down(const SimState &state)
+{
+    return state.config.bound_down + state.ball.height * 0.5f;
+}
+
+// Moves the ball through dt seconds, bouncing off paddles and walls at their
+// exact time of impact, as many times as happen within the step.
+static uint32_t moveBall(SimState &state, const MatchParams &params, float dt)
+{
+    constexpr int max_bounces = 8;
+
+    uint32_t events = SIM_EVENT_NONE;
+    float remaining = dt;
+
+    for (int bounce = 0; bounce < max_bounces && remaining > 0.0f; bounce++) {
+        Surface surface = SURFACE_NONE;
+        float toi = remaining;
+
+        // on ties the paddles win over the walls
+        float t = PaddleKernel_player_1::sweep(state, params.p1, toi);
+        if (t >= 0.0f) { toi = t; surface = SURFACE_PLAYER_1; }
+
+        t = PaddleKernel_player_2::sweep(state, params.p2, toi);
+        if (t >= 0.0f && (surface == SURFACE_NONE || t < toi)) { toi = t; surface = SURFACE_PLAYER_2; }
+
+        t = Simulation::sweep_up(state, toi);
+        if (t >= 0.0f && (surface == SURFACE_NONE || t < toi)) { toi = t; surface = SURFACE_UP; }
+
+        t = Simulation::sweep_down(state, toi);
+        if (t >= 0.0f && (surface == SURFACE_NONE || t < toi)) { toi = t; surface = SURFACE_DOWN; }
+
+        updatePosition(state.ball, toi);
+        remaining -= toi;
+
+        switch (surface) {
+        case SURFACE_NONE:
+            return events;
+
+        case SURFACE_PLAYER_1:
+            PaddleKernel_player_1::bounce(state, params.p1);
+            events |= SIM_EVENT_HIT_PLAYER_1;
+            break;
+
+        case SURFACE_PLAYER_2:
+            PaddleKernel_player_2::bounce(state, params.p2);
+            events |= SIM_EVENT_HIT_PLAYER_2;
+            break;
+
+        case SURFACE_UP:
+            state.ball.position.y = wallY_up(state);
+            state.ball.speed.y = -state.ball.speed.y;
+            events |= SIM_EVENT_HIT_WALL;
+            break;
+
+        case SURFACE_DOWN:
+            state.ball.position.y = wallY_down(state);
+            state.ball.speed.y = -state.ball.speed.y;
+            events |= SIM_EVENT_HIT_WALL;
+            break;
+        }
+    }
+
+    // out of bounces; finish the step without further collisions
+    if (remaining > 0.0f) updatePosition(state.ball, remaining);
+
+    return events;
+}
+
+static uint32_t checkBallOutOfBounds(SimState &state, const MatchParams &params)
+{
+    uint32_t events = SIM_EVENT_NONE;
+
+    switch (state.phase) {
+    case MatchPhase::Rally:
+        if (PaddleKernel_player_1::passed(state, params.p1)) {
+            state.phase = MatchPhase::PassedPlayer_1;
+            state.score_player_2++;
+            events |= SIM_EVENT_PASSED_PLAYER_1;
+        } else if (PaddleKernel_player_2::passed(state, params.p2)) {
+            state.phase = MatchPhase::PassedPlayer_2;
+            state.score_player_1++;
+            events |= SIM_EVENT_PASSED_PLAYER_2;
+        }
+        break;
+
+    case MatchPhase::PassedPlayer_1:
+        if (PaddleKernel_player_1::outOfBounds(state, params.p1)) {
+            Simulation::resetRound(state);
+            events |= SIM_EVENT_ROUND_RESET;
+        }
+        break;
+
+    case MatchPhase::PassedPlayer_2:
+        if (PaddleKernel_player_2::outOfBounds(state, params.p2)) {
+            Simulation::resetRound(state);
+            events |= SIM_EVENT_ROUND_RESET;
+        }
+        break;
+
+    case MatchPhase::Serving:
+        break;
+    }
+
+    return events;
+}
+
+void Simulation::init(SimState &state, const SimConfig &config)
+{
+    using namespace GameConstants;
+
+    state = SimState();
+    state.config = config;
+
+    state.p1.width = config.player_1_width;
+    state.p1.height = config.player_1_height;
+    state.p1.position = { PLAYER_1_POS_INITIAL[0], PLAYER_1_POS_INITIAL[1] };
+
+    state.p2.width = config.player_2_width;
+    state.p2.height = config.player_2_height;
+    state.p2.position = { PLAYER_2_POS_INITIAL[0], PLAYER_2_POS_INITIAL[1] };
+
+    state.ball.width = config.ball_width;
+    state.ball.height = config.ball_height;
+    state.ball.position = { BALL_POS_INITIAL[0], BALL_POS_INITIAL[0] };
+    state.ball.speed = { config.ball_speed_initial, 0.0f };
+}
+
+SimConfig Simulation::headlessConfig()
+{
+    SimConfig config;
+    config.serve_delay = 0.0f;
+    return config;
+}
+
+void Simulation::resetRound(SimState &state)
+{
+    using namespace GameConstants;
+
+    // with no serve delay the ball is back in play on the same tick
+    state.phase = state.config.serve_delay > 0.0f ? MatchPhase::Serving : MatchPhase::Rally;
+    state.phase_timer = state.config.serve_delay;
+
+    state.ball.position = { BALL_POS_INITIAL[0], BALL_POS_INITIAL[1] };
+    state.ball.speed = { state.config.ball_speed_initial, 0.0f };
+}
+
+uint32_t Simulation::step(SimState &state, const SimInputs &inputs, float dt)
+{
+    state.p1.speed.y = inputs.p1_dir * state.config.player_1_speed;
+    state.p2.speed.y = inputs.p2_dir * state.config.player_2_speed;
+
+    updatePosition(state.p1, dt);
+    updatePosition(state.p2, dt);
+
+    state.tick++;
+
+    // the ball waits at its spawn point until the serve countdown runs out
+    if (state.phase == MatchPhase::Serving) {
+        state.phase_timer -= dt;
+        if (state.phase_timer > 0.0f) return SIM_EVENT_NONE;
+
+        state.phase = MatchPhase::Rally;
+        state.phase_timer = 0.0f;
+        return SIM_EVENT_SERVE;
+    }
+
+    const MatchParams params = PaddleKernels::makeMatchParams(state.config);
+
+    uint32_t events = moveBall(state, params, dt);
+
+    events |= checkBallOutOfBounds(state, params);
+
+    if ((events & SIM_EVENT_ROUND_RESET) && state.phase == MatchPhase::Rally) {
+        events |= SIM_EVENT_SERVE;
+    }
+
+    return events;
+}
+
+float Simulation::sweep_player_1(const SimState &state, float max_t)
+{
+    return PaddleKernel_player_1::sweep(state, PaddleKernels::makeMatchParams(state.config).p1, max_t);
+}
+
+float Simulation::sweep_player_2(const SimState &state, float max_t)
+{
+    return PaddleKernel_player_2::sweep(state, PaddleKernels::makeMatchParams(state.config).p2, max_t);
+}
+
+float Simulation::sweep_up(const SimState &state, float max_t)
+{
+    return sweepWall(state.ball, wallY_up(state), 1.0f, max_t);
+}
+
+float Simulation::sweep_down(const SimState &state, float max_t)
+{
+    return sweepWall(state.ball, wallY_down(state), -1.0f, max_t);
+}
+
+void Simulation::saveSnapshot(const SimState &state, SimSnapshot &snapshot)
+{
+    snapshot.p1_position = state.p1.position;
+    snapshot.p1_speed = state.p1.speed;
+    snapshot.p2_position = state.p2.position;
+    snapshot.p2_speed = state.p2.speed;
+    snapshot.ball_position = state.ball.position;
+    snapshot.ball_speed = state.ball.speed;
+
+    snapshot.tick = (uint32_t)state.tick;
+    snapshot.phase_timer = state.phase_timer;
+    snapshot.score_player_1 = (uint16_t)state.score_player_1;
+    snapshot.score_player_2 = (uint16_t)state.score_player_2;
+    snapshot.phase = state.phase;
+}
+
+void Simulation::restoreSnapshot(SimState &state, const SimSnapshot &snapshot)
+{
+    state.p1.position = snapshot.p1_position;
+    state.p1.speed = snapshot.p1_speed;
+    state.p2.position = snapshot.p2_position;
+    state.p2.speed = snapshot.p2_speed;
+    state.ball.position = snapshot.ball_position;
+    state.ball.speed = snapshot.ball_speed;
+
+    state.tick = snapshot.tick;
+    state.phase_timer = snapshot.phase_timer;
+    state.score_player_1 = snapshot.score_player_1;
+    state.score_player_2 = snapshot.score_player_2;
+    state.phase = snapshot.phase;
+}
+
+uint64_t Simulation::hashState(const SimState &state)
+{
+    Fnv1a fnv;
+
+    fnv.add(state.p1);
+    fnv.add(state.p2);
+    fnv.add(state.ball);
+
+    fnv.add(&state.phase, sizeof(state.phase));
+    fnv.add(&state.phase_timer, sizeof(state.phase_timer));
+    fnv.add(&state.score_player_1, sizeof(state.score_player_1));
+    fnv.add(&state.score_player_2, sizeof(state.score_player_2));
+    fnv.add(&state.tick, sizeof(state.tick));
+
+    return fnv.hash;
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <cstdint>
+#include <type_traits>
+#include "GameConstants.hpp"
+
+// Window/GL-free game state, so matches can be stepped headlessly
+// (bots, soak tests, CI) as well as by the renderer in main.cpp.
+
+struct SimVec2
+{
+    float x;
+    float y;
+};
+
+struct SimBody
+{
+    float width = 0.0f;
+    float height = 0.0f;
+
+    SimVec2 position { 0.0f, 0.0f };
+    SimVec2 speed { 0.0f, 0.0f };
+};
+
+struct SimConfig
+{
+    float ball_speed_initial = GameConstants::BALL_SPEED_INITIAL;
+
+    float ball_speed_reflect_player_1 = GameConstants::BALL_SPEED_REFLECT_PLAYER_1;
+    float ball_speed_reflect_player_2 = GameConstants::BALL_SPEED_REFLECT_PLAYER_2;
+
+    float player_1_speed = GameConstants::PLAYER_1_SPEED;
+    float player_2_speed = GameConstants::PLAYER_2_SPEED;
+
+    float player_1_width = GameConstants::PLAYER_1_WIDTH;
+    float player_1_height = GameConstants::PLAYER_1_HEIGHT;
+
+    float player_2_width = GameConstants::PLAYER_2_WIDTH;
+    float player_2_height = GameConstants::PLAYER_2_HEIGHT;
+
+    float ball_width = GameConstants::BALL_WIDTH;
+    float ball_height = GameConstants::BALL_HEIGHT;
+
+    float bound_up = 2.0f;
+    float bound_down = -2.0f;
+    float bound_right = 2.0f;
+    float bound_left = -2.0f;
+
+    // Seconds the ball sits at its spawn point after a point. 0 skips the wait.
+    float serve_delay = (float)GameConstants::WAIT_SECONDS_BEFORE_BALL_SPAWNS;
+};
+
+// Paddle directions: +1 moves up, -1 moves down, 0 stands still.
+struct SimInputs
+{
+    int8_t p1_dir = 0;
+    int8_t p2_dir = 0;
+};
+
+// Bit flags returned by Simulation::step describing what happened during the tick.
+enum SimEvent : uint32_t
+{
+    SIM_EVENT_NONE = 0,
+    SIM_EVENT_HIT_PLAYER_1 = 1u << 0,
+    SIM_EVENT_HIT_PLAYER_2 = 1u << 1,
+    SIM_EVENT_HIT_WALL = 1u << 2,
+    SIM_EVENT_PASSED_PLAYER_1 = 1u << 3,
+    SIM_EVENT_PASSED_PLAYER_2 = 1u << 4,
+    SIM_EVENT_ROUND_RESET = 1u << 5,
+    SIM_EVENT_SERVE = 1u << 6
+};
+
+// Rally -> PassedPlayer_N once the ball gets behind a paddle (the opponent scores),
+// -> Serving when it leaves the field and respawns, -> Rally when serve_delay has elapsed.
+enum class MatchPhase : uint8_t
+{
+    Rally,
+    PassedPlayer_1,
+    PassedPlayer_2,
+    Serving
+};
+
+struct SimState
+{
+    SimConfig config;
+
+    SimBody p1;
+    SimBody p2;
+    SimBody ball;
+
+    MatchPhase phase = MatchPhase::Rally;
+    float phase_timer = 0.0f;
+
+    uint32_t score_player_1 = 0;
+    uint32_t score_player_2 = 0;
+
+    uint64_t tick = 0;
+};
+
+// The part of SimState that changes during a match, packed into one cache
+// line for rollback. Bodies keep only position and speed, sizes come from the
+// config. Ticks wrap after 2^32 (over 200 days at 240 Hz) and scores after 65535.
+struct alignas(64) SimSnapshot
+{
+    SimVec2 p1_position;
+    SimVec2 p1_speed;
+    SimVec2 p2_position;
+    SimVec2 p2_speed;
+    SimVec2 ball_position;
+    SimVec2 ball_speed;
+
+    uint32_t tick;
+    float phase_timer;
+    uint16_t score_player_1;
+    uint16_t score_player_2;
+    MatchPhase phase;
+};
+
+static_assert(sizeof(SimSnapshot) == 64, "snapshots should fill exactly one cache line");
+static_assert(std::is_trivially_copyable<SimState>::value, "SimState must stay memcpy-able");
+static_assert(std::is_trivially_copyable<SimSnapshot>::value, "SimSnapshot must stay memcpy-able");
+
+namespace Simulation {
+
+    void init(SimState &state, const SimConfig &config = SimConfig());
+    void resetRound(SimState &state);
+
+    // Default config without the serve countdown, for bots and batch runs.
+    SimConfig headlessConfig();
+
+    // Advances the match by dt seconds and returns a mask of SimEvent flags.
+    uint32_t step(SimState &state, const SimInputs &inputs, float dt);
+
+    // FNV-1a over every field that evolves during a match, for replays and
+    // desync checks. Padding bytes are never hashed.
+    uint64_t hashState(const SimState &state);
+
+    void saveSnapshot(const SimState &state, SimSnapshot &snapshot);
+    void restoreSnapshot(SimState &state, const SimSnapshot &snapshot);
+
+    // Swept collision tests step() runs, exposed for benchmarks and tools.
+    // Each returns the time in [0, max_t] until the ball touches that surface
+    // moving its current velocity, or a negative value if it doesn't.
+    float sweep_player_1(const SimState &state, float max_t);
+    float sweep_player_2(const SimState &state, float max_t);
+    float sweep_up(const SimState &state, float max_t);
+    float sweep_down(const SimState &state, float max_t);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,276 @@
+#include "Spectator.hpp"
+#include <cmath>
+
+namespace {
+
+    // LSB-first bit packing through a 64-bit scratch word
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(uint8_t *out) : out(out) {}
+
+        void write(uint32_t value, int bits)
+        {
+            if (bits < 32) value &= (1u << bits) - 1;
+
+            scratch |= (uint64_t)value << scratch_bits;
+            scratch_bits += bits;
+
+            while (scratch_bits >= 8) {
+                out[size++] = (uint8_t)scratch;
+                scratch >>= 8;
+                scratch_bits -= 8;
+            }
+        }
+
+        // Flushes the last partial byte and returns the packet size.
+        size_t finish()
+        {
+            if (scratch_bits > 0) out[size++] = (uint8_t)scratch;
+            scratch = 0;
+            scratch_bits = 0;
+            return size;
+        }
+
+    private:
+        uint8_t *out;
+        size_t size = 0;
+        uint64_t scratch = 0;
+        int scratch_bits = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t *data, size_t size) : data(data), end(data + size) {}
+
+        bool read(uint32_t &value, int bits)
+        {
+            while (scratch_bits < bits) {
+                if (data == end) return false;
+                scratch |= (uint64_t)*data++ << scratch_bits;
+                scratch_bits += 8;
+            }
+
+            value = (uint32_t)(bits < 32 ? scratch & ((1ull << bits) - 1) : scratch);
+            scratch >>= bits;
+            scratch_bits -= bits;
+            return true;
+        }
+
+    private:
+        const uint8_t *data;
+        const uint8_t *end;
+        uint64_t scratch = 0;
+        int scratch_bits = 0;
+    };
+
+    constexpr int TICK_BITS = 32;
+    constexpr int BASELINE_OFFSET_BITS = 6;
+    static_assert(SpectatorCodec::MAX_BASELINE_AGE < (1u << BASELINE_OFFSET_BITS), "baseline offset doesn't fit");
+    constexpr int SIZE_CLASS_BITS[4] = { 4, 8, 16, 32 };
+
+    inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+    inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+    inline int32_t toFixed(float value)
+    {
+        return (int32_t)std::lround(value * SpectatorFrame::SCALE);
+    }
+
+    inline float fromFixed(int32_t value)
+    {
+        return (float)value / SpectatorFrame::SCALE;
+    }
+
+    // 0 for unchanged, otherwise 1, a 2-bit size class and the zigzagged delta
+    void writeDelta(BitWriter &writer, int32_t delta)
+    {
+        if (delta == 0) {
+            writer.write(0, 1);
+            return;
+        }
+
+        uint32_t z = zigzag(delta);
+        int size_class = 0;
+        while (size_class < 3 && (z >> SIZE_CLASS_BITS[size_class]) != 0) size_class++;
+
+        writer.write(1, 1);
+        writer.write((uint32_t)size_class, 2);
+        writer.write(z, SIZE_CLASS_BITS[size_class]);
+    }
+
+    bool readDelta(BitReader &reader, int32_t &delta)
+    {
+        uint32_t changed, size_class, z;
+        if (!reader.read(changed, 1)) return false;
+
+        if (!changed) {
+            delta = 0;
+            return true;
+        }
+
+        if (!reader.read(size_class, 2) || !reader.read(z, SIZE_CLASS_BITS[size_class])) return false;
+
+        delta = unzigzag(z);
+        return true;
+    }
+}
+
+void SpectatorCodec::quantize(const SimState &state, SpectatorFrame &frame)
+{
+    using F = SpectatorFrame;
+    const SimBody *bodies[3] = { &state.p1, &state.p2, &state.ball };
+
+    for (int i = 0; i < 3; i++) {
+        frame.values[F::P1_X + i * 4] = toFixed(bodies[i]->position.x);
+        frame.values[F::P1_Y + i * 4] = toFixed(bodies[i]->position.y);
+        frame.values[F::P1_SPEED_X + i * 4] = toFixed(bodies[i]->speed.x);
+        frame.values[F::P1_SPEED_Y + i * 4] = toFixed(bodies[i]->speed.y);
+    }
+
+    frame.values[F::PHASE_TIMER] = toFixed(state.phase_timer);
+    frame.values[F::SCORE_PLAYER_1] = (int32_t)state.score_player_1;
+    frame.values[F::SCORE_PLAYER_2] = (int32_t)state.score_player_2;
+    frame.values[F::PHASE] = (int32_t)state.phase;
+
+    frame.tick = (uint32_t)state.tick;
+}
+
+void SpectatorCodec::dequantize(const SpectatorFrame &frame, SimState &state)
+{
+    using F = SpectatorFrame;
+    SimBody *bodies[3] = { &state.p1, &state.p2, &state.ball };
+
+    for (int i = 0; i < 3; i++) {
+        bodies[i]->position = { fromFixed(frame.values[F::P1_X + i * 4]), fromFixed(frame.values[F::P1_Y + i * 4]) };
+        bodies[i]->speed = { fromFixed(frame.values[F::P1_SPEED_X + i * 4]), fromFixed(frame.values[F::P1_SPEED_Y + i * 4]) };
+    }
+
+    state.phase_timer = fromFixed(frame.values[F::PHASE_TIMER]);
+    state.score_player_1 = (uint32_t)frame.values[F::SCORE_PLAYER_1];
+    state.score_player_2 = (uint32_t)frame.values[F::SCORE_PLAYER_2];
+    state.phase = (MatchPhase)frame.values[F::PHASE];
+    state.tick = frame.tick;
+}
+
+size_t SpectatorCodec::encode(const SpectatorFrame &frame, const SpectatorFrame *baseline, uint8_t *out)
+{
+    uint32_t offset = baseline ? frame.tick - baseline->tick : 0;
+    if (offset == 0 || offset > SpectatorCodec::MAX_BASELINE_AGE) {
+        offset = 0;
+        baseline = nullptr;
+    }
+
+    BitWriter writer(out);
+    writer.write(frame.tick, TICK_BITS);
+    writer.write(offset, BASELINE_OFFSET_BITS);
+
+    for (int i = 0; i < SpectatorFrame::NUM_FIELDS; i++) {
+        int32_t base = baseline ? baseline->values[i] : 0;
+        writeDelta(writer, (int32_t)((uint32_t)frame.values[i] - (uint32_t)base));
+    }
+
+    return writer.finish();
+}
+
+bool SpectatorCodec::peekBaseline(const uint8_t *data, size_t size, uint32_t &baseline_tick)
+{
+    BitReader reader(data, size);
+
+    uint32_t tick, offset;
+    if (!reader.read(tick, TICK_BITS) || !reader.read(offset, BASELINE_OFFSET_BITS)) return false;
+
+    baseline_tick = offset ? tick - offset : UINT32_MAX;
+    return true;
+}
+
+bool SpectatorCodec::decode(const uint8_t *data, size_t size, const SpectatorFrame *baseline, SpectatorFrame &frame)
+{
+    BitReader reader(data, size);
+
+    uint32_t tick, offset;
+    if (!reader.read(tick, TICK_BITS) || !reader.read(offset, BASELINE_OFFSET_BITS)) return false;
+
+    if (offset && (!baseline || baseline->tick != tick - offset)) return false;
+
+    SpectatorFrame result;
+    result.tick = tick;
+
+    for (int i = 0; i < SpectatorFrame::NUM_FIELDS; i++) {
+        int32_t delta;
+        if (!readDelta(reader, delta)) return false;
+
+        int32_t base = offset ? baseline->values[i] : 0;
+        result.values[i] = (int32_t)((uint32_t)base + (uint32_t)delta);
+    }
+
+    frame = result;
+    return true;
+}
+
+int SpectatorServer::addClient()
+{
+    client_acks.push_back(UINT32_MAX);
+    clients.push_back(0);
+    return (int)clients.size() - 1;
+}
+
+void SpectatorServer::acknowledge(int client, uint32_t tick)
+{
+    uint32_t &ack = client_acks[client];
+
+    // acks can arrive out of order; only move forward
+    if (ack == UINT32_MAX || (int32_t)(tick - ack) > 0) ack = tick;
+}
+
+void SpectatorServer::publish(const SimState &state)
+{
+    SpectatorFrame frame;
+    SpectatorCodec::quantize(state, frame);
+
+    num_packets = 0;
+
+    for (size_t c = 0; c < clients.size(); c++) {
+        const SpectatorFrame *baseline = client_acks[c] != UINT32_MAX ? history.find(client_acks[c]) : nullptr;
+        if (baseline && frame.tick - baseline->tick > SpectatorCodec::MAX_BASELINE_AGE) baseline = nullptr;
+        uint32_t baseline_tick = baseline ? baseline->tick : UINT32_MAX;
+
+        size_t index = 0;
+        while (index < num_packets && packets[index].baseline_tick != baseline_tick) index++;
+
+        if (index == num_packets) {
+            if (packets.size() <= num_packets) packets.emplace_back();
+
+            Packet &packet = packets[num_packets++];
+            packet.baseline_tick = baseline_tick;
+            packet.size = SpectatorCodec::encode(frame, baseline, packet.data);
+        }
+
+        clients[c] = index;
+    }
+
+    history.store(frame);
+}
+
+const uint8_t* SpectatorServer::getPacket(int client, size_t &size) const
+{
+    const Packet &packet = packets[clients[client]];
+    size = packet.size;
+    return packet.data;
+}
+
+bool SpectatorClient::receive(const uint8_t *data, size_t size)
+{
+    uint32_t baseline_tick;
+    if (!SpectatorCodec::peekBaseline(data, size, baseline_tick)) return false;
+
+    const SpectatorFrame *baseline = baseline_tick != UINT32_MAX ? history.find(baseline_tick) : nullptr;
+
+    SpectatorFrame frame;
+    if (!SpectatorCodec::decode(data, size, baseline, frame)) return false;
+
+    history.store(frame);
+    if (latest.tick == UINT32_MAX || (int32_t)(frame.tick - latest.tick) > 0) latest = frame;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#ifndef SPECTATOR_HPP
+#define SPECTATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Simulation.hpp"
+
+// Broadcast stream for spectators. Each tick the match is quantized to
+// fixed point and every field is sent as a bit-packed delta against the
+// newest frame the viewer has acknowledged, or in full when there is none.
+// Deltas are taken between quantized values, so server and client agree
+// on the baseline bit for bit.
+
+struct SpectatorFrame
+{
+    enum Field
+    {
+        P1_X, P1_Y, P1_SPEED_X, P1_SPEED_Y,
+        P2_X, P2_Y, P2_SPEED_X, P2_SPEED_Y,
+        BALL_X, BALL_Y, BALL_SPEED_X, BALL_SPEED_Y,
+        PHASE_TIMER,
+        SCORE_PLAYER_1,
+        SCORE_PLAYER_2,
+        PHASE,
+        NUM_FIELDS
+    };
+
+    // 1/4096 of a field unit (or second) for positions, speeds and the timer
+    static constexpr float SCALE = 4096.0f;
+
+    uint32_t tick = UINT32_MAX;
+    int32_t values[NUM_FIELDS] = {};
+};
+
+namespace SpectatorCodec {
+
+    // Older baselines can't be referenced; frames against them go out in full.
+    constexpr uint32_t MAX_BASELINE_AGE = 63;
+
+    // Packets never exceed this, whatever the deltas.
+    constexpr size_t MAX_PACKET_SIZE = 4 + 1 + SpectatorFrame::NUM_FIELDS * 5;
+
+    void quantize(const SimState &state, SpectatorFrame &frame);
+
+    // Fills the bodies, scores, phase and tick; sizes and config are left alone.
+    void dequantize(const SpectatorFrame &frame, SimState &state);
+
+    // baseline may be null for a full frame. Returns the packet size.
+    size_t encode(const SpectatorFrame &frame, const SpectatorFrame *baseline, uint8_t *out);
+
+    // Reads the baseline tick a packet was encoded against, or UINT32_MAX for
+    // a full frame. The caller looks it up and passes it to decode.
+    bool peekBaseline(const uint8_t *data, size_t size, uint32_t &baseline_tick);
+    bool decode(const uint8_t *data, size_t size, const SpectatorFrame *baseline, SpectatorFrame &frame);
+};
+
+// Recent frames by tick, so either side can find the baseline a delta refers to.
+class SpectatorHistory
+{
+public:
+    static constexpr size_t SIZE = 64;
+
+    void store(const SpectatorFrame &frame) { frames[frame.tick % SIZE] = frame; }
+
+    const SpectatorFrame* find(uint32_t tick) const
+    {
+        const SpectatorFrame &frame = frames[tick % SIZE];
+        return frame.tick == tick ? &frame : nullptr;
+    }
+
+private:
+    SpectatorFrame frames[SIZE];
+};
+
+// Encodes a match for any number of viewers. Viewers that acknowledged the
+// same baseline share one packet, so the encoding cost scales with the
+// number of distinct baselines rather than the number of viewers.
+class SpectatorServer
+{
+public:
+    int addClient();
+    void acknowledge(int client, uint32_t tick);
+
+    // Encodes this tick's state; packets stay valid until the next publish.
+    void publish(const SimState &state);
+
+    const uint8_t* getPacket(int client, size_t &size) const;
+
+    size_t getNumClients() const { return clients.size(); }
+    size_t getEncodesLastPublish() const { return num_packets; }
+
+private:
+    struct Packet
+    {
+        uint32_t baseline_tick = UINT32_MAX;
+        size_t size = 0;
+        uint8_t data[SpectatorCodec::MAX_PACKET_SIZE];
+    };
+
+    SpectatorHistory history;
+    std::vector<uint32_t> client_acks;
+    std::vector<size_t> clients;
+    std::vector<Packet> packets;
+    size_t num_packets = 0;
+};
+
+class SpectatorClient
+{
+public:
+    // Returns false for packets that are corrupt or whose baseline is gone.
+    bool receive(const uint8_t *data, size_t size);
+
+    // Newest decoded tick, to be sent back to the server.
+    uint32_t getAckTick() const { return latest.tick; }
+    const SpectatorFrame& getFrame() const { return latest; }
+
+private:
+    SpectatorHistory history;
+    SpectatorFrame latest;
+};
+
+#endif
\ No newline at end of file
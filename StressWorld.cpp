@@ -0,0 +1,246 @@
+#include "StressWorld.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "MatchRunner.hpp"
+
+static float randomUnit(uint64_t &rng)
+{
+    return (float)(MatchControllers::nextRandom(rng) >> 40) * (1.0f / 16777216.0f);
+}
+
+void StressWorld::init(const StressConfig &config, const std::vector<Rectangle2D> &obstacles)
+{
+    this->config = config;
+    this->obstacles = obstacles;
+    stats = StressStats();
+
+    // cells twice the ball size: every ball a ball can touch is in the 3x3
+    // block around its own cell, and the block stays small
+    grid.init(config.bound_left, config.bound_down, config.bound_right, config.bound_up, config.ball_size * 2.0f, config.num_balls);
+    buildObstacleCells();
+
+    const float half = config.ball_size * 0.5f;
+    const float width = config.bound_right - config.bound_left - config.ball_size;
+    const float height = config.bound_up - config.bound_down - config.ball_size;
+
+    uint64_t rng = config.seed;
+    balls.resize(config.num_balls);
+
+    for (uint32_t i = 0; i < config.num_balls; i++) {
+        StressBall &ball = balls[i];
+
+        // a few tries to start clear of the obstacles, then take what we got
+        for (int attempt = 0; attempt < 16; attempt++) {
+            ball.position.x = config.bound_left + half + randomUnit(rng) * width;
+            ball.position.y = config.bound_down + half + randomUnit(rng) * height;
+            if (!overlapsObstacle(ball.position.x, ball.position.y)) break;
+        }
+
+        float angle = randomUnit(rng) * 6.2831853f;
+        ball.speed = { std::cos(angle) * config.ball_speed, std::sin(angle) * config.ball_speed };
+
+        grid.update(i, ball.position.x, ball.position.y);
+    }
+}
+
+std::vector<Rectangle2D> StressWorld::defaultObstacles()
+{
+    std::vector<Rectangle2D> rects;
+
+    rects.emplace_back(0.4f, 0.4f, Point2D{ 0.0f, 0.0f });
+
+    rects.emplace_back(1.6f, 0.08f, Point2D{ 0.0f, 1.2f });
+    rects.emplace_back(1.6f, 0.08f, Point2D{ 0.0f, -1.2f });
+
+    rects.emplace_back(0.08f, 1.0f, Point2D{ -1.5f, 0.0f });
+    rects.emplace_back(0.08f, 1.0f, Point2D{ 1.5f, 0.0f });
+
+    for (float x : { -0.9f, 0.9f }) {
+        for (float y : { -0.6f, 0.6f }) {
+            rects.emplace_back(0.15f, 0.15f, Point2D{ x, y });
+        }
+    }
+
+    return rects;
+}
+
+bool StressWorld::overlapsObstacle(float x, float y) const
+{
+    const float half = config.ball_size * 0.5f;
+
+    for (const Rectangle2D &rect : obstacles) {
+        if (std::fabs(x - rect.position.x) < rect.width * 0.5f + half &&
+            std::fabs(y - rect.position.y) < rect.height * 0.5f + half) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void StressWorld::buildObstacleCells()
+{
+    const float half = config.ball_size * 0.5f;
+    const int num_cells = grid.getNumCells();
+
+    obstacle_cell_starts.assign((size_t)num_cells + 1, 0);
+    obstacle_cell_items.clear();
+
+    // count first, then fill; each obstacle grows by half a ball so the
+    // ball's centre cell is enough to find it
+    for (int pass = 0; pass < 2; pass++) {
+        std::vector<uint32_t> cursor(obstacle_cell_starts.begin(), obstacle_cell_starts.end() - 1);
+
+        for (uint32_t o = 0; o < (uint32_t)obstacles.size(); o++) {
+            const Rectangle2D &rect = obstacles[o];
+
+            int low = grid.cellOf(rect.position.x - rect.width * 0.5f - half, rect.position.y - rect.height * 0.5f - half);
+            int high = grid.cellOf(rect.position.x + rect.width * 0.5f + half, rect.position.y + rect.height * 0.5f + half);
+
+            for (int row = grid.getRow(low); row <= grid.getRow(high); row++) {
+                for (int col = grid.getCol(low); col <= grid.getCol(high); col++) {
+                    int cell = grid.getCell(col, row);
+
+                    if (pass == 0) obstacle_cell_starts[cell + 1]++;
+                    else obstacle_cell_items[cursor[cell]++] = o;
+                }
+            }
+        }
+
+        if (pass == 0) {
+            for (int cell = 0; cell < num_cells; cell++) {
+                obstacle_cell_starts[cell + 1] += obstacle_cell_starts[cell];
+            }
+            obstacle_cell_items.resize(obstacle_cell_starts[num_cells]);
+        }
+    }
+}
+
+void StressWorld::step(float dt)
+{
+    // the tests are discrete, so split the tick until no ball moves half its
+    // size along either axis; swaps and bounces never raise a speed component
+    // above ball_speed
+    int substeps = 1 + (int)(config.ball_speed * dt / (config.ball_size * 0.5f));
+    float sub_dt = dt / (float)substeps;
+
+    for (int s = 0; s < substeps; s++) {
+        substep(sub_dt);
+    }
+
+    stats.ticks++;
+}
+
+void StressWorld::substep(float dt)
+{
+    for (uint32_t i = 0; i < (uint32_t)balls.size(); i++) {
+        StressBall &ball = balls[i];
+
+        ball.position.x += ball.speed.x * dt;
+        ball.position.y += ball.speed.y * dt;
+        collideBounds(ball);
+
+        // most balls stay in their cell from one tick to the next
+        if (grid.update(i, ball.position.x, ball.position.y)) stats.cell_moves++;
+    }
+
+    for (uint32_t i = 0; i < (uint32_t)balls.size(); i++) {
+        collideObstacles(i);
+        collideNeighbours(i);
+    }
+}
+
+void StressWorld::collideBounds(StressBall &ball)
+{
+    const float half = config.ball_size * 0.5f;
+
+    if (ball.position.x > config.bound_right - half && ball.speed.x > 0.0f) {
+        ball.position.x = config.bound_right - half;
+        ball.speed.x = -ball.speed.x;
+    } else if (ball.position.x < config.bound_left + half && ball.speed.x < 0.0f) {
+        ball.position.x = config.bound_left + half;
+        ball.speed.x = -ball.speed.x;
+    }
+
+    if (ball.position.y > config.bound_up - half && ball.speed.y > 0.0f) {
+        ball.position.y = config.bound_up - half;
+        ball.speed.y = -ball.speed.y;
+    } else if (ball.position.y < config.bound_down + half && ball.speed.y < 0.0f) {
+        ball.position.y = config.bound_down + half;
+        ball.speed.y = -ball.speed.y;
+    }
+}
+
+void StressWorld::collideObstacles(uint32_t index)
+{
+    const float half = config.ball_size * 0.5f;
+
+    StressBall &ball = balls[index];
+    int cell = grid.cellOf(ball.position.x, ball.position.y);
+
+    for (uint32_t k = obstacle_cell_starts[cell]; k < obstacle_cell_starts[cell + 1]; k++) {
+        const Rectangle2D &rect = obstacles[obstacle_cell_items[k]];
+
+        float dx = ball.position.x - rect.position.x;
+        float dy = ball.position.y - rect.position.y;
+        float px = rect.width * 0.5f + half - std::fabs(dx);
+        float py = rect.height * 0.5f + half - std::fabs(dy);
+        if (px <= 0.0f || py <= 0.0f) continue;
+
+        stats.obstacle_hits++;
+
+        // push out along the shallower axis and bounce if still moving in
+        if (px < py) {
+            ball.position.x += dx < 0.0f ? -px : px;
+            if (ball.speed.x * dx < 0.0f) ball.speed.x = -ball.speed.x;
+        } else {
+            ball.position.y += dy < 0.0f ? -py : py;
+            if (ball.speed.y * dy < 0.0f) ball.speed.y = -ball.speed.y;
+        }
+    }
+}
+
+void StressWorld::collideNeighbours(uint32_t index)
+{
+    const float size = config.ball_size;
+
+    StressBall &ball = balls[index];
+    int cell = grid.cellOf(ball.position.x, ball.position.y);
+    int col = grid.getCol(cell);
+    int row = grid.getRow(cell);
+
+    for (int r = std::max(row - 1, 0); r <= std::min(row + 1, grid.getRows() - 1); r++) {
+        for (int c = std::max(col - 1, 0); c <= std::min(col + 1, grid.getCols() - 1); c++) {
+            for (uint32_t j = grid.first(grid.getCell(c, r)); j != UniformGrid::NONE; j = grid.next(j)) {
+                // each pair is handled once, by its lower index
+                if (j <= index) continue;
+                stats.pair_tests++;
+
+                StressBall &other = balls[j];
+
+                float dx = other.position.x - ball.position.x;
+                float dy = other.position.y - ball.position.y;
+                float px = size - std::fabs(dx);
+                float py = size - std::fabs(dy);
+                if (px <= 0.0f || py <= 0.0f) continue;
+
+                stats.ball_hits++;
+
+                // equal masses: an elastic hit swaps the velocities along the
+                // contact axis, and each ball takes half the separation
+                if (px < py) {
+                    float push = (dx < 0.0f ? -px : px) * 0.5f;
+                    ball.position.x -= push;
+                    other.position.x += push;
+                    if ((other.speed.x - ball.speed.x) * dx < 0.0f) std::swap(ball.speed.x, other.speed.x);
+                } else {
+                    float push = (dy < 0.0f ? -py : py) * 0.5f;
+                    ball.position.y -= push;
+                    other.position.y += push;
+                    if ((other.speed.y - ball.speed.y) * dy < 0.0f) std::swap(ball.speed.y, other.speed.y);
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef STRESS_WORLD_HPP
+#define STRESS_WORLD_HPP
+
+#include <cstdint>
+#include <vector>
+#include "Shapes2D.hpp"
+#include "Simulation.hpp"
+#include "UniformGrid.hpp"
+
+struct StressConfig
+{
+    uint32_t num_balls = 2000;
+    float ball_size = 0.02f;
+    float ball_speed = 1.0f;
+    uint64_t seed = 1;
+
+    float bound_up = 2.0f;
+    float bound_down = -2.0f;
+    float bound_right = 2.0f;
+    float bound_left = -2.0f;
+};
+
+struct StressBall
+{
+    SimVec2 position;
+    SimVec2 speed;
+};
+
+struct StressStats
+{
+    uint64_t ticks = 0;
+    uint64_t pair_tests = 0;
+    uint64_t ball_hits = 0;
+    uint64_t obstacle_hits = 0;
+    uint64_t cell_moves = 0;
+};
+
+// Load test for the physics and the renderer: thousands of square balls
+// bouncing off the bounds, static rectangular obstacles and each other.
+// Balls live in a uniform grid that is updated incrementally every tick, and
+// each obstacle is listed in every cell it can touch a ball from, so a tick
+// costs O(balls) instead of O(balls^2). The tests are discrete, so step()
+// splits a tick into substeps that each move a ball less than half its size.
+class StressWorld
+{
+public:
+    void init(const StressConfig &config, const std::vector<Rectangle2D> &obstacles);
+    void step(float dt);
+
+    // A few bars and blocks spread over the field.
+    static std::vector<Rectangle2D> defaultObstacles();
+
+    const StressConfig& getConfig() const { return config; }
+    const std::vector<StressBall>& getBalls() const { return balls; }
+    const std::vector<Rectangle2D>& getObstacles() const { return obstacles; }
+    const StressStats& getStats() const { return stats; }
+
+private:
+    void substep(float dt);
+    bool overlapsObstacle(float x, float y) const;
+    void buildObstacleCells();
+
+    void collideBounds(StressBall &ball);
+    void collideObstacles(uint32_t index);
+    void collideNeighbours(uint32_t index);
+
+    StressConfig config;
+    StressStats stats;
+
+    std::vector<StressBall> balls;
+    std::vector<Rectangle2D> obstacles;
+
+    UniformGrid grid;
+
+    // obstacles per cell, flattened: cell c owns [starts[c], starts[c + 1])
+    std::vector<uint32_t> obstacle_cell_starts;
+    std::vector<uint32_t> obstacle_cell_items;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,337 @@
+#include "TextRenderer.hpp"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include "GLState.hpp"
+
+namespace {
+
+    constexpr int FIRST_CHAR = 32;
+    constexpr int NUM_CHARS = 95;
+    constexpr int ATLAS_COLUMNS = 16;
+    constexpr int ATLAS_ROWS = (NUM_CHARS + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+
+    // printable ASCII, 5 columns per glyph, bit 0 is the top row and bit 7 the
+    // bottom of the descenders
+    constexpr unsigned char FONT_5X7[NUM_CHARS][5] =
+    {
+        { 0x00, 0x00, 0x00, 0x00, 0x00 },  //  
+        { 0x00, 0x00, 0x5F, 0x00, 0x00 },  // !
+        { 0x00, 0x07, 0x00, 0x07, 0x00 },  // "
+        { 0x14, 0x7F, 0x14, 0x7F, 0x14 },  // #
+        { 0x24, 0x2A, 0x7F, 0x2A, 0x12 },  // $
+        { 0x23, 0x13, 0x08, 0x64, 0x62 },  // %
+        { 0x36, 0x49, 0x56, 0x20, 0x50 },  // &
+        { 0x00, 0x08, 0x07, 0x03, 0x00 },  // '
+        { 0x00, 0x1C, 0x22, 0x41, 0x00 },  // (
+        { 0x00, 0x41, 0x22, 0x1C, 0x00 },  // )
+        { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A },  // *
+        { 0x08, 0x08, 0x3E, 0x08, 0x08 },  // +
+        { 0x00, 0x80, 0x70, 0x30, 0x00 },  // ,
+        { 0x08, 0x08, 0x08, 0x08, 0x08 },  // -
+        { 0x00, 0x00, 0x60, 0x60, 0x00 },  // .
+        { 0x20, 0x10, 0x08, 0x04, 0x02 },  // /
+        { 0x3E, 0x51, 0x49, 0x45, 0x3E },  // 0
+        { 0x00, 0x42, 0x7F, 0x40, 0x00 },  // 1
+        { 0x72, 0x49, 0x49, 0x49, 0x46 },  // 2
+        { 0x21, 0x41, 0x49, 0x4D, 0x33 },  // 3
+        { 0x18, 0x14, 0x12, 0x7F, 0x10 },  // 4
+        { 0x27, 0x45, 0x45, 0x45, 0x39 },  // 5
+        { 0x3C, 0x4A, 0x49, 0x49, 0x31 },  // 6
+        { 0x41, 0x21, 0x11, 0x09, 0x07 },  // 7
+        { 0x36, 0x49, 0x49, 0x49, 0x36 },  // 8
+        { 0x46, 0x49, 0x49, 0x29, 0x1E },  // 9
+        { 0x00, 0x00, 0x14, 0x00, 0x00 },  // :
+        { 0x00, 0x40, 0x34, 0x00, 0x00 },  // ;
+        { 0x00, 0x08, 0x14, 0x22, 0x41 },  // <
+        { 0x14, 0x14, 0x14, 0x14, 0x14 },  // =
+        { 0x00, 0x41, 0x22, 0x14, 0x08 },  // >
+        { 0x02, 0x01, 0x59, 0x09, 0x06 },  // ?
+        { 0x3E, 0x41, 0x5D, 0x59, 0x4E },  // @
+        { 0x7C, 0x12, 0x11, 0x12, 0x7C },  // A
+        { 0x7F, 0x49, 0x49, 0x49, 0x36 },  // B
+        { 0x3E, 0x41, 0x41, 0x41, 0x22 },  // C
+        { 0x7F, 0x41, 0x41, 0x41, 0x3E },  // D
+        { 0x7F, 0x49, 0x49, 0x49, 0x41 },  // E
+        { 0x7F, 0x09, 0x09, 0x09, 0x01 },  // F
+        { 0x3E, 0x41, 0x41, 0x51, 0x73 },  // G
+        { 0x7F, 0x08, 0x08, 0x08, 0x7F },  // H
+        { 0x00, 0x41, 0x7F, 0x41, 0x00 },  // I
+        { 0x20, 0x40, 0x41, 0x3F, 0x01 },  // J
+        { 0x7F, 0x08, 0x14, 0x22, 0x41 },  // K
+        { 0x7F, 0x40, 0x40, 0x40, 0x40 },  // L
+        { 0x7F, 0x02, 0x1C, 0x02, 0x7F },  // M
+        { 0x7F, 0x04, 0x08, 0x10, 0x7F },  // N
+        { 0x3E, 0x41, 0x41, 0x41, 0x3E },  // O
+        { 0x7F, 0x09, 0x09, 0x09, 0x06 },  // P
+        { 0x3E, 0x41, 0x51, 0x21, 0x5E },  // Q
+        { 0x7F, 0x09, 0x19, 0x29, 0x46 },  // R
+        { 0x26, 0x49, 0x49, 0x49, 0x32 },  // S
+        { 0x01, 0x01, 0x7F, 0x01, 0x01 },  // T
+        { 0x3F, 0x40, 0x40, 0x40, 0x3F },  // U
+        { 0x1F, 0x20, 0x40, 0x20, 0x1F },  // V
+        { 0x3F, 0x40, 0x38, 0x40, 0x3F },  // W
+        { 0x63, 0x14, 0x08, 0x14, 0x63 },  // X
+        { 0x03, 0x04, 0x78, 0x04, 0x03 },  // Y
+        { 0x61, 0x59, 0x49, 0x4D, 0x43 },  // Z
+        { 0x00, 0x7F, 0x41, 0x41, 0x41 },  // [
+        { 0x02, 0x04, 0x08, 0x10, 0x20 },  // backslash
+        { 0x00, 0x41, 0x41, 0x41, 0x7F },  // ]
+        { 0x04, 0x02, 0x01, 0x02, 0x04 },  // ^
+        { 0x40, 0x40, 0x40, 0x40, 0x40 },  // _
+        { 0x00, 0x03, 0x07, 0x08, 0x00 },  // `
+        { 0x20, 0x54, 0x54, 0x78, 0x40 },  // a
+        { 0x7F, 0x28, 0x44, 0x44, 0x38 },  // b
+        { 0x38, 0x44, 0x44, 0x44, 0x28 },  // c
+        { 0x38, 0x44, 0x44, 0x28, 0x7F },  // d
+        { 0x38, 0x54, 0x54, 0x54, 0x18 },  // e
+        { 0x00, 0x08, 0x7E, 0x09, 0x02 },  // f
+        { 0x18, 0xA4, 0xA4, 0xA4, 0x7C },  // g
+        { 0x7F, 0x08, 0x04, 0x04, 0x78 },  // h
+        { 0x00, 0x44, 0x7D, 0x40, 0x00 },  // i
+        { 0x20, 0x40, 0x40, 0x3D, 0x00 },  // j
+        { 0x7F, 0x10, 0x28, 0x44, 0x00 },  // k
+        { 0x00, 0x41, 0x7F, 0x40, 0x00 },  // l
+        { 0x7C, 0x04, 0x78, 0x04, 0x78 },  // m
+        { 0x7C, 0x08, 0x04, 0x04, 0x78 },  // n
+        { 0x38, 0x44, 0x44, 0x44, 0x38 },  // o
+        { 0xFC, 0x24, 0x24, 0x24, 0x18 },  // p
+        { 0x18, 0x24, 0x24, 0x24, 0xFC },  // q
+        { 0x7C, 0x08, 0x04, 0x04, 0x08 },  // r
+        { 0x48, 0x54, 0x54, 0x54, 0x24 },  // s
+        { 0x04, 0x04, 0x3F, 0x44, 0x24 },  // t
+        { 0x3C, 0x40, 0x40, 0x20, 0x7C },  // u
+        { 0x1C, 0x20, 0x40, 0x20, 0x1C },  // v
+        { 0x3C, 0x40, 0x30, 0x40, 0x3C },  // w
+        { 0x44, 0x28, 0x10, 0x28, 0x44 },  // x
+        { 0x4C, 0x90, 0x90, 0x90, 0x7C },  // y
+        { 0x44, 0x64, 0x54, 0x4C, 0x44 },  // z
+        { 0x00, 0x08, 0x36, 0x41, 0x00 },  // {
+        { 0x00, 0x00, 0x77, 0x00, 0x00 },  // |
+        { 0x00, 0x41, 0x36, 0x08, 0x00 },  // }
+        { 0x02, 0x01, 0x02, 0x04, 0x02 },  // ~
+    };
+
+    int glyphIndex(char c)
+    {
+        int index = (unsigned char)c - FIRST_CHAR;
+        return index >= 0 && index < NUM_CHARS ? index : '?' - FIRST_CHAR;
+    }
+}
+
+TextRenderer::TextRenderer()
+{
+
+}
+
+void TextRenderer::init(const char *cache_path)
+{
+    static const char* vertex_shader_code = "                                                                   \n\
+    #version 330                                                                                            \n\
+                                                                                                            \n\
+    // x, y of the top left corner in pixels, atlas index and scale                                         \n\
+    layout(location = 0) in vec4 glyph;                                                                     \n\
+                                                                                                            \n\
+    uniform vec2 screen_size;                                                                               \n\
+                                                                                                            \n\
+    out vec2 texel;                                                                                         \n\
+                                                                                                            \n\
+    void main()                                                                                             \n\
+    {                                                                                                       \n\
+        // a triangle strip over the corners of the cell, no vertex buffer needed                           \n\
+        vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);                                              \n\
+        vec2 cell = vec2(6.0, 8.0);                                                                         \n\
+        int index = int(glyph.z);                                                                           \n\
+                                                                                                            \n\
+        texel = (vec2(index % 16, index / 16) + corner) * cell;                                             \n\
+                                                                                                            \n\
+        vec2 p = glyph.xy + corner * cell * glyph.w;                                                        \n\
+        gl_Position = vec4(p.x / screen_size.x * 2.0 - 1.0, 1.0 - p.y / screen_size.y * 2.0, 0.0, 1.0);     \n\
+    }                                                                                                       \n\
+    ";
+
+    // fragment shader
+    static const char* fragment_shader_code = "                                                                 \n\
+    #version 330                                                                                            \n\
+                                                                                                            \n\
+    uniform sampler2D atlas;                                                                                \n\
+    uniform vec4 color;                                                                                     \n\
+                                                                                                            \n\
+    in vec2 texel;                                                                                          \n\
+    out vec4 frag_color;                                                                                    \n\
+                                                                                                            \n\
+    void main()                                                                                             \n\
+    {                                                                                                       \n\
+        // the atlas is a 0/1 bitmap, so a discard replaces blending                                        \n\
+        if (texelFetch(atlas, ivec2(texel), 0).r < 0.5) discard;                                            \n\
+        frag_color = color;                                                                                 \n\
+    }                                                                                                       \n\
+    ";
+
+    Shader v_shader{ 0, GL_VERTEX_SHADER, vertex_shader_code };
+    Shader f_shader{ 0, GL_FRAGMENT_SHADER, fragment_shader_code };
+
+    shader_handler.add(v_shader);
+    shader_handler.add(f_shader);
+
+    if (cache_path) shader_handler.setBinaryCache(cache_path);
+
+    shader_handler.compileShaders();
+    shader_handler.linkShaders();
+
+    // the atlas upload overlaps the driver's shader build
+    createAtlas();
+
+    instances.reserve(MAX_GLYPHS * 4);
+    instance_stream.create(GL_ARRAY_BUFFER, MAX_GLYPHS * 4 * sizeof(GLfloat));
+
+    glGenVertexArrays(1, &id_vao);
+    GLState::bindVertexArray(id_vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instance_stream.getId());
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
+    glVertexAttribDivisor(0, 1);
+    glEnableVertexAttribArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
+
+    shader_handler.validateShaders();
+
+    screen_size_location = shader_handler.getUniformVariableId("screen_size");
+    color_location = shader_handler.getUniformVariableId("color");
+    atlas_location = shader_handler.getUniformVariableId("atlas");
+}
+
+void TextRenderer::createAtlas()
+{
+    const int width = ATLAS_COLUMNS * GLYPH_WIDTH;
+    const int height = ATLAS_ROWS * GLYPH_HEIGHT;
+
+    std::vector<unsigned char> pixels((size_t)(width * height), 0);
+
+    for (int index = 0; index < NUM_CHARS; index++) {
+        int x0 = (index % ATLAS_COLUMNS) * GLYPH_WIDTH;
+        int y0 = (index / ATLAS_COLUMNS) * GLYPH_HEIGHT;
+
+        for (int col = 0; col < 5; col++) {
+            for (int row = 0; row < GLYPH_HEIGHT; row++) {
+                if (FONT_5X7[index][col] & (1 << row)) pixels[(size_t)((y0 + row) * width + x0 + col)] = 255;
+            }
+        }
+    }
+
+    glGenTextures(1, &id_atlas);
+    GLState::bindTexture(ATLAS_TEXTURE_UNIT, GL_TEXTURE_2D, id_atlas);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    // texelFetch ignores filtering, but a mipmapped min filter would leave the texture incomplete
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+void TextRenderer::destroy()
+{
+    instance_stream.destroy();
+
+    if (id_vao) glDeleteVertexArrays(1, &id_vao);
+    if (id_atlas) glDeleteTextures(1, &id_atlas);
+    id_vao = 0;
+    id_atlas = 0;
+
+    GLState::invalidate();
+}
+
+void TextRenderer::begin(int screen_width, int screen_height)
+{
+    // keeps capacity, so steady-state frames don't allocate
+    instances.clear();
+    screen_size = { (GLfloat)screen_width, (GLfloat)screen_height };
+    draw_calls = 0;
+    dropped_glyphs = 0;
+}
+
+void TextRenderer::add(GLfloat x, GLfloat y, GLfloat scale, const char *text)
+{
+    GLfloat pen_x = x;
+    GLfloat advance = GLYPH_WIDTH * scale;
+
+    for (const char *c = text; *c; c++) {
+        if (*c == '\n') {
+            pen_x = x;
+            y += (GLYPH_HEIGHT + 2) * scale;
+            continue;
+        }
+
+        // spaces take room but need no quad
+        if (*c != ' ') {
+            if (getNumGlyphs() >= MAX_GLYPHS) {
+                dropped_glyphs++;
+                continue;
+            }
+
+            instances.push_back(pen_x);
+            instances.push_back(y);
+            instances.push_back((GLfloat)glyphIndex(*c));
+            instances.push_back(scale);
+        }
+
+        pen_x += advance;
+    }
+}
+
+void TextRenderer::print(GLfloat x, GLfloat y, GLfloat scale, const char *format, ...)
+{
+    char text[256];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    add(x, y, scale, text);
+}
+
+GLfloat TextRenderer::measure(const char *text, GLfloat scale)
+{
+    size_t longest = 0;
+    size_t line = 0;
+
+    for (const char *c = text; *c; c++) {
+        line = *c == '\n' ? 0 : line + 1;
+        if (line > longest) longest = line;
+    }
+
+    return (GLfloat)longest * GLYPH_WIDTH * scale;
+}
+
+void TextRenderer::draw()
+{
+    GLuint num_glyphs = getNumGlyphs();
+    if (num_glyphs == 0) return;
+
+    GLintptr offset = 0;
+    GLsizeiptr size = (GLsizeiptr)(instances.size() * sizeof(GLfloat));
+
+    void* dst = instance_stream.map(size, offset);
+    memcpy(dst, instances.data(), (size_t)size);
+    instance_stream.unmap();
+
+    shader_handler.enableShaders();
+    shader_handler.setUniform(screen_size_location, screen_size);
+    shader_handler.setUniform(color_location, color);
+    shader_handler.setUniform(atlas_location, (GLint)ATLAS_TEXTURE_UNIT);
+
+    GLState::bindTexture(ATLAS_TEXTURE_UNIT, GL_TEXTURE_2D, id_atlas);
+
+    // the ring moves every frame, so point attribute 0 at this frame's slice
+    GLState::bindVertexArray(id_vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instance_stream.getId());
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)offset);
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, num_glyphs);
+    draw_calls++;
+
+    instance_stream.endFrame();
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef TEXT_RENDERER_HPP
+#define TEXT_RENDERER_HPP
+
+#include <vector>
+#include <GL/glew.h>
+#include "BufferHandler.hpp"
+#include "Shader.hpp"
+
+// Screen-space HUD text from a 5x7 bitmap font baked into a single-channel
+// atlas at init. Every glyph added during a frame becomes one instance
+// (x, y, atlas index, scale) in a streamed vertex buffer, and draw() submits
+// them all with one instanced draw. Positions are in pixels from the top left;
+// a glyph cell is GLYPH_WIDTH x GLYPH_HEIGHT pixels at scale 1. Capacity is
+// fixed at MAX_GLYPHS, so adding text never allocates; glyphs past it are dropped.
+class TextRenderer
+{
+public:
+    static constexpr int GLYPH_WIDTH = 6;
+    static constexpr int GLYPH_HEIGHT = 8;
+    static constexpr GLuint MAX_GLYPHS = 4096;
+    static constexpr GLuint ATLAS_TEXTURE_UNIT = 1;
+
+    TextRenderer();
+
+    // Builds the atlas and the text program, optionally through a program binary cache.
+    void init(const char *cache_path = nullptr);
+    void destroy();
+
+    void begin(int screen_width, int screen_height);
+    void add(GLfloat x, GLfloat y, GLfloat scale, const char *text);
+    void print(GLfloat x, GLfloat y, GLfloat scale, const char *format, ...);
+    void setColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) { color = { r, g, b, a }; }
+    void draw();
+
+    static GLfloat measure(const char *text, GLfloat scale);
+
+    GLuint getNumGlyphs() const { return (GLuint)(instances.size() / 4); }
+    GLuint getDrawCalls() const { return draw_calls; }
+    GLuint getDroppedGlyphs() const { return dropped_glyphs; }
+
+private:
+    void createAtlas();
+
+    ShaderHandler shader_handler;
+    StreamingBuffer instance_stream;
+    std::vector<GLfloat> instances;
+
+    GLuint id_vao{};
+    GLuint id_atlas{};
+    GLint screen_size_location = -1;
+    GLint color_location = -1;
+    GLint atlas_location = -1;
+
+    glm::vec4 color{ .7f, .7f, .7f, 1.0f };
+    glm::vec2 screen_size{ 1.0f, 1.0f };
+    GLuint draw_calls = 0;
+    GLuint dropped_glyphs = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "UniformBuffer.hpp"
+#include <cstring>
+#include "GLState.hpp"
+
+UniformBuffer::UniformBuffer()
+{
+
+}
+
+void UniformBuffer::create(GLuint binding_point, GLsizeiptr size)
+{
+    binding = binding_point;
+    shadow.assign((size_t)size, 0);
+
+    glGenBuffers(1, &id_ubo);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, id_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, size, shadow.data(), GL_DYNAMIC_DRAW);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, binding, id_ubo);
+}
+
+void UniformBuffer::update(const void *data, GLsizeiptr size, GLintptr offset)
+{
+    if (offset + size > (GLsizeiptr)shadow.size()) return;
+
+    // the CPU copy lets unchanged frames skip the upload entirely
+    if (memcmp(&shadow[offset], data, (size_t)size) == 0) return;
+    memcpy(&shadow[offset], data, (size_t)size);
+
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, id_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef UNIFORM_BUFFER_HPP
+#define UNIFORM_BUFFER_HPP
+
+#include <vector>
+#include <GL/glew.h>
+
+// std140 uniform block storage bound to a fixed binding point, so the same
+// data (e.g. view_projection) is uploaded once and read by every program
+// that binds its block to that point with ShaderHandler::bindUniformBlock.
+class UniformBuffer
+{
+public:
+    UniformBuffer();
+
+    void create(GLuint binding, GLsizeiptr size);
+    void update(const void *data, GLsizeiptr size, GLintptr offset = 0);
+
+    GLuint getBinding() const { return binding; }
+
+private:
+    GLuint id_ubo{};
+    GLuint binding{};
+    std::vector<unsigned char> shadow;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "UniformGrid.hpp"
+#include <algorithm>
+#include <cmath>
+
+void UniformGrid::init(float left, float down, float right, float up, float cell_size, uint32_t max_items)
+{
+    this->left = left;
+    this->down = down;
+    inv_cell_size = 1.0f / cell_size;
+
+    cols = std::max(1, (int)std::ceil((right - left) * inv_cell_size));
+    rows = std::max(1, (int)std::ceil((up - down) * inv_cell_size));
+
+    heads.assign((size_t)cols * rows, NONE);
+    links.assign(max_items, Link());
+}
+
+int UniformGrid::cellOf(float x, float y) const
+{
+    int col = std::min(std::max((int)((x - left) * inv_cell_size), 0), cols - 1);
+    int row = std::min(std::max((int)((y - down) * inv_cell_size), 0), rows - 1);
+    return getCell(col, row);
+}
+
+bool UniformGrid::update(uint32_t item, float x, float y)
+{
+    int cell = cellOf(x, y);
+    if (links[item].cell == cell) return false;
+
+    remove(item);
+
+    Link &link = links[item];
+    link.cell = cell;
+    link.prev = NONE;
+    link.next = heads[cell];
+
+    if (link.next != NONE) links[link.next].prev = item;
+    heads[cell] = item;
+
+    return true;
+}
+
+void UniformGrid::remove(uint32_t item)
+{
+    Link &link = links[item];
+    if (link.cell < 0) return;
+
+    if (link.prev != NONE) links[link.prev].next = link.next;
+    else heads[link.cell] = link.next;
+
+    if (link.next != NONE) links[link.next].prev = link.prev;
+
+    link = Link();
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef UNIFORM_GRID_HPP
+#define UNIFORM_GRID_HPP
+
+#include <cstdint>
+#include <vector>
+
+// Uniform spatial hash over a fixed rectangle. Every item sits in exactly one
+// cell, kept in an intrusive doubly linked list per cell, so moving an item
+// between cells is O(1) and items that stay in their cell cost nothing.
+// Positions outside the rectangle are clamped to the border cells.
+class UniformGrid
+{
+public:
+    static constexpr uint32_t NONE = 0xffffffffu;
+
+    void init(float left, float down, float right, float up, float cell_size, uint32_t max_items);
+
+    int cellOf(float x, float y) const;
+    int getCol(int cell) const { return cell % cols; }
+    int getRow(int cell) const { return cell / cols; }
+    int getCell(int col, int row) const { return row * cols + col; }
+
+    // Puts the item in the cell holding (x, y). Returns true if it changed cell.
+    bool update(uint32_t item, float x, float y);
+    void remove(uint32_t item);
+
+    uint32_t first(int cell) const { return heads[cell]; }
+    uint32_t next(uint32_t item) const { return links[item].next; }
+
+    int getCols() const { return cols; }
+    int getRows() const { return rows; }
+    int getNumCells() const { return cols * rows; }
+
+private:
+    struct Link
+    {
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        int32_t cell = -1;
+    };
+
+    float left = 0.0f;
+    float down = 0.0f;
+    float inv_cell_size = 1.0f;
+    int cols = 1;
+    int rows = 1;
+
+    std::vector<uint32_t> heads;
+    std::vector<Link> links;
+};
+
+#endif
\ No newline at end of file